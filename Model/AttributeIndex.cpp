@@ -0,0 +1,38 @@
+//========================================================================
+//
+// Copyright (C) 2018 Matthieu Bruel <Matthieu.Bruel@gmail.com>
+//
+// This file is a part of miniEMF++ : https://github.com/mbruel/miniEMF
+//
+// miniEMF++ is free software; you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as
+// published by the Free Software Foundation; version 3.0 of the License.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+// You should have received a copy of the GNU Lesser General Public
+// License along with this program; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301,
+// USA.
+//
+//========================================================================
+
+#include "AttributeIndex.h"
+#include "MObject.h"
+#include <algorithm>
+
+AttributeIndex::AttributeIndex(MObjectType *mObjectType, Property *property, KIND kind):
+    _mObjectType(mObjectType), _property(property), _kind(kind)
+{}
+
+bool AttributeIndex::isIndexing(MObject *mObject) const
+{
+    return mObject->isA(_mObjectType);
+}
+
+void AttributeIndex::_sortById(MObjectList &mObjects)
+{
+    std::sort(mObjects.begin(), mObjects.end(), &MObject::elementIdLessThan);
+}
@@ -0,0 +1,237 @@
+//========================================================================
+//
+// Copyright (C) 2018 Matthieu Bruel <Matthieu.Bruel@gmail.com>
+//
+// This file is a part of miniEMF++ : https://github.com/mbruel/miniEMF
+//
+// miniEMF++ is free software; you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as
+// published by the Free Software Foundation; version 3.0 of the License.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+// You should have received a copy of the GNU Lesser General Public
+// License along with this program; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301,
+// USA.
+//
+//========================================================================
+
+#ifndef ATTRIBUTEINDEX_H
+#define ATTRIBUTEINDEX_H
+
+#include "aliases.h"
+#include "PropertyObserver.h"
+#include <QHash>
+#include <QMultiHash>
+#include <QMultiMap>
+
+class MObjectType;
+
+/**
+ * @brief AttributeIndex is a secondary index on an AttributeProperty
+ * of the MObjects of a type (and its derived types) in a Model
+ *
+ * It is created and owned by the Model (cf Model::createHashIndex and Model::createOrderedIndex)
+ * that adds and removes the MObjects. It observes its Property to be updated when the values change.
+ * - HashAttributeIndex: equality queries
+ * - OrderedAttributeIndex: equality and range queries
+ */
+class AttributeIndex : public PropertyObserver
+{
+public:
+    enum class KIND
+    {
+        HASH,
+        ORDERED
+    };
+
+    ~AttributeIndex() override = default;
+
+    AttributeIndex(const AttributeIndex &other) = delete;
+    AttributeIndex(AttributeIndex &&other) = delete;
+
+    AttributeIndex & operator=(const AttributeIndex &other) = delete;
+    AttributeIndex & operator=(AttributeIndex &&other) = delete;
+
+    inline MObjectType *getModelObjectType() const;
+    inline Property    *getProperty() const;
+    inline KIND         getKind() const;
+
+    bool isIndexing(MObject *mObject) const; //!< is the MObject of the type (or of a derived one)
+
+    virtual void insert(MObject *mObject) = 0; //!< only if isIndexing
+    virtual void remove(MObject *mObject) = 0;
+    virtual void clear() = 0;
+    virtual int  size() const = 0;
+
+protected:
+    AttributeIndex(MObjectType *mObjectType, Property *property, KIND kind);
+
+    static void _sortById(MObjectList &mObjects);
+
+    MObjectType *const _mObjectType;
+    Property    *const _property;
+    const KIND         _kind;
+};
+
+
+template<typename TypeAttribute, template <typename...> class Container>
+class TypedAttributeIndex : public AttributeIndex
+{
+public:
+    ~TypedAttributeIndex() override;
+
+    void insert(MObject *mObject) override;
+    void remove(MObject *mObject) override;
+    void clear() override;
+    int  size() const override { return _indexedValues.size(); }
+
+    MObjectList find(const TypeAttribute &value) const; //!< sorted by id
+    inline bool contains(const TypeAttribute &value) const;
+
+    void propertyValueChanged(MObject *mObject, Property *property) override;
+
+protected:
+    TypedAttributeIndex(MObjectType *mObjectType, AttributeProperty<TypeAttribute> *property, KIND kind);
+
+    AttributeProperty<TypeAttribute> *const _attributeProperty;
+    Container<TypeAttribute, MObject*>      _index;
+    QHash<MObject*, TypeAttribute>          _indexedValues; //!< value under which each MObject is indexed
+};
+
+
+template<typename TypeAttribute>
+class HashAttributeIndex : public TypedAttributeIndex<TypeAttribute, QMultiHash>
+{
+public:
+    HashAttributeIndex(MObjectType *mObjectType, AttributeProperty<TypeAttribute> *property);
+};
+
+
+template<typename TypeAttribute>
+class OrderedAttributeIndex : public TypedAttributeIndex<TypeAttribute, QMultiMap>
+{
+public:
+    OrderedAttributeIndex(MObjectType *mObjectType, AttributeProperty<TypeAttribute> *property);
+
+    //! lowerBound <= value <= upperBound (sorted by value)
+    MObjectList findInRange(const TypeAttribute &lowerBound, const TypeAttribute &upperBound) const;
+};
+
+
+////////////////////////////////
+/// inline functions definition
+////////////////////////////////
+MObjectType *AttributeIndex::getModelObjectType() const { return _mObjectType; }
+Property *AttributeIndex::getProperty() const { return _property; }
+AttributeIndex::KIND AttributeIndex::getKind() const { return _kind; }
+
+
+////////////////////////////////////////////
+/// Template functions definition (generic)
+////////////////////////////////////////////
+template<typename TypeAttribute, template <typename...> class Container>
+TypedAttributeIndex<TypeAttribute, Container>::TypedAttributeIndex(MObjectType *mObjectType,
+                                                                   AttributeProperty<TypeAttribute> *property,
+                                                                   KIND kind):
+    AttributeIndex(mObjectType, property, kind),
+    _attributeProperty(property), _index(), _indexedValues()
+{
+    _attributeProperty->addObserver(this);
+}
+
+template<typename TypeAttribute, template <typename...> class Container>
+TypedAttributeIndex<TypeAttribute, Container>::~TypedAttributeIndex()
+{
+    _attributeProperty->removeObserver(this);
+}
+
+template<typename TypeAttribute, template <typename...> class Container>
+void TypedAttributeIndex<TypeAttribute, Container>::insert(MObject *mObject)
+{
+    if (isIndexing(mObject) && !_indexedValues.contains(mObject))
+    {
+        TypeAttribute value = _attributeProperty->getValue(mObject);
+        _index.insert(value, mObject);
+        _indexedValues.insert(mObject, value);
+    }
+}
+
+template<typename TypeAttribute, template <typename...> class Container>
+void TypedAttributeIndex<TypeAttribute, Container>::remove(MObject *mObject)
+{
+    auto it = _indexedValues.find(mObject);
+    if (it != _indexedValues.end())
+    {
+        _index.remove(it.value(), mObject);
+        _indexedValues.erase(it);
+    }
+}
+
+template<typename TypeAttribute, template <typename...> class Container>
+void TypedAttributeIndex<TypeAttribute, Container>::clear()
+{
+    _index.clear();
+    _indexedValues.clear();
+}
+
+template<typename TypeAttribute, template <typename...> class Container>
+MObjectList TypedAttributeIndex<TypeAttribute, Container>::find(const TypeAttribute &value) const
+{
+    MObjectList mObjects = _index.values(value);
+    if (mObjects.size() > 1)
+        _sortById(mObjects);
+    return mObjects;
+}
+
+template<typename TypeAttribute, template <typename...> class Container>
+bool TypedAttributeIndex<TypeAttribute, Container>::contains(const TypeAttribute &value) const
+{
+    return _index.contains(value);
+}
+
+template<typename TypeAttribute, template <typename...> class Container>
+void TypedAttributeIndex<TypeAttribute, Container>::propertyValueChanged(MObject *mObject, Property *property)
+{
+    Q_UNUSED(property);
+    auto it = _indexedValues.find(mObject);
+    if (it != _indexedValues.end())
+    {
+        TypeAttribute newValue = _attributeProperty->getValue(mObject);
+        if (!(newValue == it.value()))
+        {
+            _index.remove(it.value(), mObject);
+            _index.insert(newValue, mObject);
+            it.value() = newValue;
+        }
+    }
+}
+
+
+template<typename TypeAttribute>
+HashAttributeIndex<TypeAttribute>::HashAttributeIndex(MObjectType *mObjectType, AttributeProperty<TypeAttribute> *property):
+    TypedAttributeIndex<TypeAttribute, QMultiHash>(mObjectType, property, AttributeIndex::KIND::HASH)
+{}
+
+
+template<typename TypeAttribute>
+OrderedAttributeIndex<TypeAttribute>::OrderedAttributeIndex(MObjectType *mObjectType, AttributeProperty<TypeAttribute> *property):
+    TypedAttributeIndex<TypeAttribute, QMultiMap>(mObjectType, property, AttributeIndex::KIND::ORDERED)
+{}
+
+template<typename TypeAttribute>
+MObjectList OrderedAttributeIndex<TypeAttribute>::findInRange(const TypeAttribute &lowerBound, const TypeAttribute &upperBound) const
+{
+    MObjectList mObjects;
+    if (upperBound < lowerBound)
+        return mObjects;
+
+    for (auto it = this->_index.lowerBound(lowerBound), itEnd = this->_index.upperBound(upperBound); it != itEnd ; ++it)
+        mObjects.append(it.value());
+    return mObjects;
+}
+
+#endif // ATTRIBUTEINDEX_H
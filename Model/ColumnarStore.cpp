@@ -0,0 +1,115 @@
+//========================================================================
+//
+// Copyright (C) 2018 Matthieu Bruel <Matthieu.Bruel@gmail.com>
+//
+// This file is a part of miniEMF++ : https://github.com/mbruel/miniEMF
+//
+// miniEMF++ is free software; you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as
+// published by the Free Software Foundation; version 3.0 of the License.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+// You should have received a copy of the GNU Lesser General Public
+// License along with this program; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301,
+// USA.
+//
+//========================================================================
+
+#include "ColumnarStore.h"
+#include "MObject.h"
+#include "Property.h"
+
+ColumnarStore::ColumnarStore(MObjectType *mObjectType):
+    _mObjectType(mObjectType), _propertyLayout(nullptr), _columns(), _rows()
+{}
+
+ColumnarStore::~ColumnarStore()
+{
+    detachAll();
+    qDeleteAll(_columns);
+}
+
+void ColumnarStore::_initColumns(MObject *mObject)
+{
+    _propertyLayout = mObject->_propertyLayout;
+    _columns.fill(nullptr, _propertyLayout->nbRawSlots());
+    for (Property *property : _propertyLayout->getProperties())
+    {
+        if (property->isUnboxed())
+            _columns[property->getSlot()] = property->createAttributeColumn();
+    }
+}
+
+void ColumnarStore::attach(MObject *mObject)
+{
+    if (mObject->_columnarStore)
+        return; // already in a store (shared MObject of a subModel)
+
+    if (!_propertyLayout)
+        _initColumns(mObject);
+
+    for (int slot = 0 ; slot < _columns.size() ; ++slot)
+    {
+        AttributeColumn *column = _columns.at(slot);
+        if (column)
+            column->append(mObject->_rawPropertyValues.at(slot));
+    }
+
+    mObject->_columnarStore = this;
+    mObject->_columnarRow   = _rows.size();
+    _rows.append(mObject);
+}
+
+void ColumnarStore::detach(MObject *mObject)
+{
+    if (mObject->_columnarStore != this)
+        return;
+
+    // get back the values
+    int row = mObject->_columnarRow;
+    for (int slot = 0 ; slot < _columns.size() ; ++slot)
+    {
+        AttributeColumn *column = _columns.at(slot);
+        if (column)
+        {
+            mObject->_rawPropertyValues[slot] = column->rawValue(row);
+            column->removeRow(row);
+        }
+    }
+    mObject->_columnarStore = nullptr;
+    mObject->_columnarRow   = -1;
+
+    // the last row has been moved in place of the removed one
+    MObject *lastModelObject = _rows.last();
+    _rows.removeLast();
+    if (lastModelObject != mObject)
+    {
+        _rows[row] = lastModelObject;
+        lastModelObject->_columnarRow = row;
+    }
+}
+
+void ColumnarStore::detachAll()
+{
+    while (!_rows.isEmpty())
+        detach(_rows.last());
+}
+
+bool ColumnarStore::hasColumn(const Property *property) const
+{
+    return _propertyLayout && property->isUnboxed() && _propertyLayout->hasProperty(property);
+}
+
+PropertyRawValue ColumnarStore::getRawValue(const Property *property, int row) const
+{
+    return _columns.at(property->getSlot())->rawValue(row);
+}
+
+void ColumnarStore::setRawValue(const Property *property, int row, const PropertyRawValue &rawValue)
+{
+    _columns.at(property->getSlot())->setRawValue(row, rawValue);
+}
@@ -0,0 +1,164 @@
+//========================================================================
+//
+// Copyright (C) 2018 Matthieu Bruel <Matthieu.Bruel@gmail.com>
+//
+// This file is a part of miniEMF++ : https://github.com/mbruel/miniEMF
+//
+// miniEMF++ is free software; you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as
+// published by the Free Software Foundation; version 3.0 of the License.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+// You should have received a copy of the GNU Lesser General Public
+// License along with this program; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301,
+// USA.
+//
+//========================================================================
+
+#ifndef COLUMNARSTORE_H
+#define COLUMNARSTORE_H
+
+#include "aliases.h"
+#include "PropertyRawValue.h"
+#include <QVector>
+
+class MObject;
+class MObjectType;
+class PropertyLayout;
+
+//! column of values of an unboxed AttributeProperty (cf Property::createAttributeColumn)
+class AttributeColumn
+{
+public:
+    virtual ~AttributeColumn() = default;
+
+    virtual void append(const PropertyRawValue &rawValue) = 0;
+    virtual PropertyRawValue rawValue(int row) const = 0;
+    virtual void setRawValue(int row, const PropertyRawValue &rawValue) = 0;
+    virtual void removeRow(int row) = 0; //!< the last row is moved in place of the removed one
+    virtual void clear() = 0;
+};
+
+template<typename TypeAttribute> class TypedAttributeColumn : public AttributeColumn
+{
+public:
+    TypedAttributeColumn() = default;
+    ~TypedAttributeColumn() override = default;
+
+    void append(const PropertyRawValue &rawValue) override { _values.append(rawValue.get<TypeAttribute>()); }
+    PropertyRawValue rawValue(int row) const override;
+    void setRawValue(int row, const PropertyRawValue &rawValue) override { _values[row] = rawValue.get<TypeAttribute>(); }
+    void removeRow(int row) override;
+    void clear() override { _values.clear(); }
+
+    inline const QVector<TypeAttribute> &values() const { return _values; }
+    inline const TypeAttribute &value(int row) const { return _values.at(row); }
+    inline void setValue(int row, const TypeAttribute &value) { _values[row] = value; }
+
+private:
+    QVector<TypeAttribute> _values;
+};
+
+
+/**
+ * @brief ColumnarStore keeps the unboxed attributes (bool, int, float, double)
+ * of the MObjects of an instanciable MObjectType in contiguous columns (one per Property)
+ *
+ * It is optional and owned by a Model (cf Model::enableColumnarStorage).
+ * An attached MObject holds its row in the columns, its own PropertyRawValue
+ * are only used again once it is detached (the values are copied back).
+ * The rows are not ordered: removing a MObject moves the last row in its place.
+ */
+class ColumnarStore
+{
+public:
+    explicit ColumnarStore(MObjectType *mObjectType);
+    ~ColumnarStore();
+
+    ColumnarStore(const ColumnarStore &other) = delete;
+    ColumnarStore(ColumnarStore &&other) = delete;
+
+    ColumnarStore & operator=(const ColumnarStore &other) = delete;
+    ColumnarStore & operator=(ColumnarStore &&other) = delete;
+
+    void attach(MObject *mObject);
+    void detach(MObject *mObject);
+    void detachAll();
+
+    inline MObjectType *getModelObjectType() const;
+    inline int size() const;
+    inline const QVector<MObject*> &getModelObjects() const; //!< MObject of each row
+
+    template<typename TypeAttribute> const QVector<TypeAttribute> *getColumn(AttributeProperty<TypeAttribute> *property) const;
+    bool hasColumn(const Property *property) const;
+
+    template<typename TypeAttribute> inline TypeAttribute getValue(AttributeProperty<TypeAttribute> *property, int row) const;
+    template<typename TypeAttribute> inline void setValue(AttributeProperty<TypeAttribute> *property, int row, const TypeAttribute &value);
+
+    PropertyRawValue getRawValue(const Property *property, int row) const;
+    void setRawValue(const Property *property, int row, const PropertyRawValue &rawValue);
+
+private:
+    void _initColumns(MObject *mObject);
+
+    MObjectType *const        _mObjectType;
+    const PropertyLayout     *_propertyLayout; //!< of the MObjects of the type (set by the first attach)
+    QVector<AttributeColumn*> _columns; //!< indexed by the slots of the unboxed properties (nullptr if not used by the type)
+    QVector<MObject*>         _rows;
+};
+
+
+////////////////////////////////
+/// inline functions definition
+////////////////////////////////
+MObjectType *ColumnarStore::getModelObjectType() const { return _mObjectType; }
+int ColumnarStore::size() const { return _rows.size(); }
+const QVector<MObject *> &ColumnarStore::getModelObjects() const { return _rows; }
+
+
+////////////////////////////////////////////
+/// Template functions definition (generic)
+////////////////////////////////////////////
+template<typename TypeAttribute>
+PropertyRawValue TypedAttributeColumn<TypeAttribute>::rawValue(int row) const
+{
+    PropertyRawValue rawValue;
+    rawValue.set<TypeAttribute>(_values.at(row));
+    return rawValue;
+}
+
+template<typename TypeAttribute>
+void TypedAttributeColumn<TypeAttribute>::removeRow(int row)
+{
+    int lastRow = _values.size() - 1;
+    if (row != lastRow)
+        _values[row] = _values.at(lastRow);
+    _values.removeLast();
+}
+
+template<typename TypeAttribute>
+const QVector<TypeAttribute> *ColumnarStore::getColumn(AttributeProperty<TypeAttribute> *property) const
+{
+    if (hasColumn(property))
+        return &(static_cast<TypedAttributeColumn<TypeAttribute>*>(_columns.at(property->getSlot()))->values());
+    else
+        return nullptr;
+}
+
+template<typename TypeAttribute>
+TypeAttribute ColumnarStore::getValue(AttributeProperty<TypeAttribute> *property, int row) const
+{
+    return static_cast<TypedAttributeColumn<TypeAttribute>*>(_columns.at(property->getSlot()))->value(row);
+}
+
+template<typename TypeAttribute>
+void ColumnarStore::setValue(AttributeProperty<TypeAttribute> *property, int row, const TypeAttribute &value)
+{
+    static_cast<TypedAttributeColumn<TypeAttribute>*>(_columns.at(property->getSlot()))->setValue(row, value);
+}
+
+#endif // COLUMNARSTORE_H
@@ -0,0 +1,134 @@
+//========================================================================
+//
+// Copyright (C) 2018 Matthieu Bruel <Matthieu.Bruel@gmail.com>
+//
+// This file is a part of miniEMF++ : https://github.com/mbruel/miniEMF
+//
+// miniEMF++ is free software; you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as
+// published by the Free Software Foundation; version 3.0 of the License.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+// You should have received a copy of the GNU Lesser General Public
+// License along with this program; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301,
+// USA.
+//
+//========================================================================
+
+#include "ElemId.h"
+#include <QVector>
+#include <QReadWriteLock>
+#include <QReadLocker>
+#include <QWriteLocker>
+
+namespace
+{
+QVector<QString>        sInternedIds;     //!< indexed by the value of the interned ElemId (without the flag)
+QHash<QString, quint64> sInternedIndexes;
+QReadWriteLock          sInternedIdsLock; //!< toString only reads: the writers are the new foreign ids
+}
+
+ElemId::ElemId(int typeId, uint modelId, uint sequence):
+    _value(0)
+{
+    if (typeId < 0 || static_cast<quint64>(typeId) > sMaxTypeId || modelId > sMaxModelId
+            || (typeId == 0 && modelId == 0 && sequence == 0)) // would be the null id
+        _value = _intern(QString("%1_%2_%3").arg(typeId).arg(modelId).arg(sequence))._value;
+    else
+        _value = (static_cast<quint64>(typeId) << sTypeIdShift)
+                | (static_cast<quint64>(modelId) << sModelIdShift)
+                | sequence;
+}
+
+ElemId ElemId::fromString(const QString &strId)
+{
+    return fromString(strId.constData(), strId.size());
+}
+
+ElemId ElemId::fromString(const QChar *strId, int size)
+{
+    if (size == 0)
+        return ElemId();
+
+    // parse "typeId_modelId_sequence" without regexp
+    quint64 fields[3] = {0, 0, 0};
+    int field = 0, nbDigits = 0;
+    for (int i = 0 ; i < size ; ++i)
+    {
+        ushort c = strId[i].unicode();
+        if (c == '_')
+        {
+            if (nbDigits == 0 || ++field > 2)
+                return _intern(QString(strId, size));
+            nbDigits = 0;
+        }
+        else if (c >= '0' && c <= '9')
+        {
+            if ((nbDigits == 1 && fields[field] == 0) || nbDigits == 10)
+                return _intern(QString(strId, size)); // leading zero or too big: it wouldn't round-trip
+            fields[field] = fields[field] * 10 + (c - '0');
+            ++nbDigits;
+        }
+        else
+            return _intern(QString(strId, size));
+    }
+
+    if (field != 2 || nbDigits == 0 || fields[0] > sMaxTypeId || fields[1] > sMaxModelId
+            || fields[2] > 0xFFFFFFFF || (fields[0] | fields[1] | fields[2]) == 0)
+        return _intern(QString(strId, size));
+
+    return ElemId((fields[0] << sTypeIdShift) | (fields[1] << sModelIdShift) | fields[2]);
+}
+
+QString ElemId::toString() const
+{
+    if (isNull())
+        return QString();
+    else if (isPacked())
+        return QString::number(typeId()) + '_' + QString::number(modelId()) + '_' + QString::number(sequence());
+    else
+    {
+        QReadLocker lock(&sInternedIdsLock);
+        return sInternedIds.at(static_cast<int>(_value & ~sInternedFlag));
+    }
+}
+
+ElemId ElemId::_intern(const QString &strId)
+{
+    {
+        QReadLocker lock(&sInternedIdsLock);
+        auto it = sInternedIndexes.constFind(strId);
+        if (it != sInternedIndexes.cend())
+            return ElemId(it.value() | sInternedFlag);
+    }
+
+    QWriteLocker lock(&sInternedIdsLock);
+    auto it = sInternedIndexes.constFind(strId); // another thread may have interned it meanwhile
+    if (it != sInternedIndexes.cend())
+        return ElemId(it.value() | sInternedFlag);
+
+    quint64 index = static_cast<quint64>(sInternedIds.size());
+    sInternedIds.append(strId);
+    sInternedIndexes.insert(strId, index);
+    return ElemId(index | sInternedFlag);
+}
+
+bool ElemId::_isInternedLessThan(const ElemId &other) const
+{
+    if (_value == other._value)
+        return false;
+
+    QReadLocker lock(&sInternedIdsLock);
+    return sInternedIds.at(static_cast<int>(_value & ~sInternedFlag))
+            < sInternedIds.at(static_cast<int>(other._value & ~sInternedFlag));
+}
+
+QDebug operator<<(QDebug debug, const ElemId &elemId)
+{
+    debug << elemId.toString();
+    return debug;
+}
@@ -0,0 +1,106 @@
+//========================================================================
+//
+// Copyright (C) 2018 Matthieu Bruel <Matthieu.Bruel@gmail.com>
+//
+// This file is a part of miniEMF++ : https://github.com/mbruel/miniEMF
+//
+// miniEMF++ is free software; you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as
+// published by the Free Software Foundation; version 3.0 of the License.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+// You should have received a copy of the GNU Lesser General Public
+// License along with this program; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301,
+// USA.
+//
+//========================================================================
+
+#ifndef ELEMID_H
+#define ELEMID_H
+
+#include <QString>
+#include <QHash>
+#include <QDebug>
+
+/**
+ * @brief ElemId is the identifier of a MObject packed in 64 bits: (typeId, modelId, sequence)
+ *
+ * It is compared and hashed as an integer, the legacy string form "typeId_modelId_sequence"
+ * is only used at the XMI boundary (cf fromString / toString).
+ * The ids that can't be packed (foreign XMI ids, fields out of range, leading zeros...)
+ * are interned in a global table so that they still round-trip exactly.
+ * This table is shared by all the Models of the process and only grows:
+ * it holds one string per distinct foreign id ever loaded, they are never released.
+ *
+ * The packed ids are ordered by value and come before the interned ones,
+ * that are ordered by their string (so that the order doesn't depend on the interning order).
+ */
+class ElemId
+{
+public:
+    constexpr ElemId() : _value(0) {}
+    ElemId(int typeId, uint modelId, uint sequence);
+
+    static ElemId fromString(const QString &strId);
+    static ElemId fromString(const QChar *strId, int size); //!< no allocation for the packed ids
+    QString toString() const;
+
+    inline bool isNull() const;
+    inline bool isPacked() const; //!< false for the interned ids
+    inline int  typeId() const;   //!< only for the packed ids
+    inline uint modelId() const;  //!< only for the packed ids
+    inline uint sequence() const; //!< only for the packed ids
+
+    inline quint64 toUInt64() const;
+    static inline ElemId fromUInt64(quint64 value); //!< inverse of toUInt64 (only for the packed ids, the interned ones are not persistent)
+
+    inline bool operator==(const ElemId &other) const;
+    inline bool operator!=(const ElemId &other) const;
+    inline bool operator<(const ElemId &other) const;
+
+private:
+    explicit constexpr ElemId(quint64 value) : _value(value) {}
+    static ElemId _intern(const QString &strId);
+    bool _isInternedLessThan(const ElemId &other) const;
+
+    quint64 _value; //!< [interned flag (1 bit)][typeId (15 bits)][modelId (16 bits)][sequence (32 bits)]
+
+    static constexpr quint64 sInternedFlag = Q_UINT64_C(1) << 63;
+    static constexpr int     sTypeIdShift  = 48;
+    static constexpr int     sModelIdShift = 32;
+    static constexpr quint64 sMaxTypeId    = 0x7FFF;
+    static constexpr quint64 sMaxModelId   = 0xFFFF;
+};
+Q_DECLARE_TYPEINFO(ElemId, Q_PRIMITIVE_TYPE);
+
+inline uint qHash(const ElemId &elemId, uint seed = 0) { return qHash(elemId.toUInt64(), seed); }
+QDebug operator<<(QDebug debug, const ElemId &elemId);
+
+
+////////////////////////////////
+/// inline functions definition
+////////////////////////////////
+bool ElemId::isNull()   const { return _value == 0; }
+bool ElemId::isPacked() const { return !(_value & sInternedFlag); }
+int  ElemId::typeId()   const { return static_cast<int>((_value >> sTypeIdShift) & sMaxTypeId); }
+uint ElemId::modelId()  const { return static_cast<uint>((_value >> sModelIdShift) & sMaxModelId); }
+uint ElemId::sequence() const { return static_cast<uint>(_value); }
+
+quint64 ElemId::toUInt64() const { return _value; }
+ElemId ElemId::fromUInt64(quint64 value) { return ElemId(value); }
+
+bool ElemId::operator==(const ElemId &other) const { return _value == other._value; }
+bool ElemId::operator!=(const ElemId &other) const { return _value != other._value; }
+bool ElemId::operator<(const ElemId &other)  const
+{
+    if (isPacked() || other.isPacked())
+        return _value < other._value; // the flag puts the interned ids after the packed ones
+    else
+        return _isInternedLessThan(other);
+}
+
+#endif // ELEMID_H
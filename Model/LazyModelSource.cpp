@@ -0,0 +1,41 @@
+//========================================================================
+//
+// Copyright (C) 2018 Matthieu Bruel <Matthieu.Bruel@gmail.com>
+//
+// This file is a part of miniEMF++ : https://github.com/mbruel/miniEMF
+//
+// miniEMF++ is free software; you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as
+// published by the Free Software Foundation; version 3.0 of the License.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+// You should have received a copy of the GNU Lesser General Public
+// License along with this program; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301,
+// USA.
+//
+//========================================================================
+
+#include "LazyModelSource.h"
+#include "MObject.h"
+
+void LazyModelSource::_attach(MObject *mObject, LazyModelSource *lazySource, uint record)
+{
+    mObject->_lazySource   = lazySource;
+    mObject->_lazyRecord   = record;
+    mObject->_hasLazyLinks = true;
+}
+
+void LazyModelSource::_detach(MObject *mObject)
+{
+    mObject->_lazySource   = nullptr;
+    mObject->_hasLazyLinks = false;
+}
+
+void LazyModelSource::_loadLinks(MObject *mObject)
+{
+    mObject->_loadLazyLinks();
+}
@@ -0,0 +1,83 @@
+//========================================================================
+//
+// Copyright (C) 2018 Matthieu Bruel <Matthieu.Bruel@gmail.com>
+//
+// This file is a part of miniEMF++ : https://github.com/mbruel/miniEMF
+//
+// miniEMF++ is free software; you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as
+// published by the Free Software Foundation; version 3.0 of the License.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+// You should have received a copy of the GNU Lesser General Public
+// License along with this program; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301,
+// USA.
+//
+//========================================================================
+
+#ifndef LAZYMODELSOURCE_H
+#define LAZYMODELSOURCE_H
+
+#include "ElemId.h"
+
+class MObject;
+class MObjectType;
+class Model;
+
+/**
+ * @brief LazyModelSource holds MObjects that are not created yet (cf SnapshotService::openSnapshot)
+ *
+ * It is optional and owned by a Model (cf Model::setLazySource).
+ * The Model asks it for the MObjects it doesn't have yet when they are first needed:
+ * getModelObjectById, the iteration on a type (getModelObjectsView, forEachModelObject...)
+ * or the whole Model (validate, clone...). A created MObject is added in the Model
+ * but its links stay in the source until the first access to one of them
+ * (then the MObjects they point to are created the same way).
+ * As a Model, it is not thread safe: the parallel operations materialize everything first.
+ */
+class LazyModelSource
+{
+    friend class Model;   // to set _model
+    friend class MObject; // to load its links and detach it
+
+public:
+    LazyModelSource() : _model(nullptr) {}
+    virtual ~LazyModelSource() = default;
+
+    LazyModelSource(const LazyModelSource &other) = delete;
+    LazyModelSource & operator=(const LazyModelSource &other) = delete;
+
+    //! create the MObject of the type (or a derived one) having the id if it is still in the source (nullptr otherwise)
+    virtual MObject *materializeModelObject(MObjectType *mObjectType, const ElemId &id) = 0;
+    //! create all the MObjects of an instanciable type that are still in the source
+    virtual void materializeModelObjects(MObjectType *mObjectType) = 0;
+    //! create all the MObjects and load all their links (the source is not used anymore)
+    virtual void materializeAll() = 0;
+
+    inline Model *getModel() const;
+
+protected:
+    //! set the links of a MObject created by the source (on the first access to one of them)
+    virtual void loadLinks(MObject *mObject, uint record) = 0;
+    //! the MObject is being deleted
+    virtual void detach(MObject *mObject, uint record) = 0;
+
+    // the state of the MObjects (LazyModelSource is a friend of MObject)
+    static void _attach(MObject *mObject, LazyModelSource *lazySource, uint record); //!< with its links still in the source
+    static void _detach(MObject *mObject); //!< the links not loaded yet are lost
+    static void _loadLinks(MObject *mObject);
+
+    Model *_model; //!< where the MObjects are added
+};
+
+
+////////////////////////////////
+/// inline functions definition
+////////////////////////////////
+Model *LazyModelSource::getModel() const { return _model; }
+
+#endif // LAZYMODELSOURCE_H
@@ -70,12 +70,8 @@ QString MObject::getDefaultName()
 
 void MObject::validateLinkProperties(QStringList &ecoreErrors)
 {
-    for (auto it = _propertyValueMap.cbegin(), itEnd = _propertyValueMap.cend(); it != itEnd; ++it)
-    {
-        Property *property = it.key();
-        if (property->isALinkProperty())
-            static_cast<LinkProperty*>(property)->validateModelObject(this, ecoreErrors);
-    }
+    for (LinkProperty *linkProperty : _propertyLayout->getLinkProperties())
+        linkProperty->validateModelObject(this, ecoreErrors);
 }
 
 bool MObject::validateBusinessRules(QStringList &businessErrors, MObject *owner)
@@ -87,11 +83,9 @@ bool MObject::validateBusinessRules(QStringList &businessErrors, MObject *owner)
 
 Property *MObject::getPropertyFromName(const QString &propertyName) const
 {
-    for (auto it = _propertyValueMap.cbegin(), itEnd = _propertyValueMap.cend(); it != itEnd ; ++it)
-    {
-        if (it.key()->getName() == propertyName)
-            return it.key();
-    }
+    Property *property = _propertyLayout->getClassPropertyMap()->value(propertyName, nullptr);
+    if (property && _propertyLayout->hasProperty(property))
+        return property;
     return nullptr;
 }
 
@@ -102,20 +96,109 @@ Property *MObject::getPropertyFromName(const QString &propertyName) const
 
 
 
-void MObject::_initPropertyValueMap(QMap<QString, Property*>* classPropertyMap)
+void MObject::_initPropertyValues()
 {
-    for (auto it = classPropertyMap->cbegin(), itEnd = classPropertyMap->cend(); it != itEnd; ++it) {
-        Property *property = it.value();
-        _propertyValueMap[property] = property->createNewInitValue();
+    _propertyValues.resize(_propertyLayout->nbSlots());
+    _rawPropertyValues.resize(_propertyLayout->nbRawSlots());
+    _smallSetValues.resize(_propertyLayout->nbSmallSetSlots()); // empty links
+    for (int slot = 0 ; slot < _propertyValues.size() ; ++slot)
+    {
+        Property *property = _propertyLayout->getPropertyAtSlot(slot);
+        if (property)
+            _propertyValues[slot] = property->createNewInitValue();
+    }
+    for (int slot = 0 ; slot < _rawPropertyValues.size() ; ++slot)
+    {
+        Property *property = _propertyLayout->getPropertyAtRawSlot(slot);
+        if (property)
+            _rawPropertyValues[slot] = property->createNewInitRawValue();
     }
 }
 
+void MObject::_copyAttributeValue(const MObject *srcElem, Property *property)
+{
+    const bool isMapKey = property->hasPropertiesUsingAsKey();
+    MapKey oldMapKey;
+    if (isMapKey)
+        oldMapKey = property->getMapKey(this);
+
+    if (property->isUnboxed())
+        _setRawValue(property, srcElem->_getRawValue(property));
+    else
+        _value(property) = srcElem->_value(property);
+
+    if (isMapKey)
+        _updateMapKeys(property, oldMapKey);
+    property->notifyValueChanged(this);
+}
+
+PropertyRawValue MObject::_getRawValue(const Property *property) const
+{
+    if (_columnarStore)
+        return _columnarStore->getRawValue(property, _columnarRow);
+    else
+        return _rawValue(property);
+}
+
+void MObject::_setRawValue(const Property *property, const PropertyRawValue &rawValue)
+{
+    if (_columnarStore)
+        _columnarStore->setRawValue(property, _columnarRow, rawValue);
+    else
+        _rawValue(property) = rawValue;
+}
+
 
 
 
 void MObject::setPropertyValueFromQVariant(Property *property, const QVariant &value)
 {
-    _propertyValueMap.insert(property, value);
+    if (!_propertyLayout->hasProperty(property))
+        qCritical() << "[MObject::setPropertyValueFromQVariant] ERROR: " << getModelObjectTypeName()
+                    << " doesn't have the property " << property->getName();
+    else
+    {
+        const bool isMapKey = property->hasPropertiesUsingAsKey();
+        MapKey oldMapKey;
+        if (isMapKey)
+            oldMapKey = property->getMapKey(this);
+        if (property->isALinkProperty())
+            _loadLazyLinks(); // so the source doesn't overwrite the new value later
+
+        if (property->isUnboxed())
+            _setRawValue(property, property->toRawValue(value));
+        else if (property->isSmallSetLink())
+        {   // copy the MObjectSmallSet pointed by the value
+            MObjectSmallSet *values = static_cast<MObjectSmallSet*>(value.value<void*>());
+            MObjectSmallSet *propertyValues = getLinkPropertyValue<MObjectSmallSet>(property);
+            if (values)
+                *propertyValues = *values;
+            else
+                propertyValues->clear();
+        }
+        else
+            _propertyValues[property->getSlot()] = value;
+
+        if (isMapKey)
+            _updateMapKeys(property, oldMapKey);
+        property->notifyValueChanged(this);
+    }
+}
+
+QVariant MObject::getPropertyVariant(Property *property) const
+{
+    if (!_propertyLayout->hasProperty(property))
+        return QVariant();
+    else if (property->isUnboxed())
+        return property->toVariant(_getRawValue(property));
+    else if (property->isSmallSetLink())
+        return QVariant::fromValue(static_cast<void*>(getLinkPropertyValue<MObjectSmallSet>(property)));
+    else
+    {
+        if (property->isALinkProperty())
+            _loadLazyLinks();
+        return _value(property);
+    }
 }
 
 void MObject::setPropertyValueFromElement(LinkProperty* property, MObject* value)
@@ -124,77 +207,137 @@ void MObject::setPropertyValueFromElement(LinkProperty* property, MObject* value
 }
 
 
-QVariant MObject::getPropertyMapKey(Property *mapProperty)
+// Template specializations of addALinkToMany for SmallSet, OrderedSet, QMap and QMultiMap
+template <> void MObject::addALinkToMany<SmallSet>(Property *property, MObject *value)
 {
-    if (mapProperty->isALinkProperty() && static_cast<LinkProperty*>(mapProperty)->isMapProperty())
-        return getPropertyVariant(static_cast<MapLinkProperty*>(mapProperty)->getKey());
-    else
-        return getName();
+    if (value)
+    {
+        MObjectSmallSet *propertyValues = getOrCreateLinkPropertyValue<MObjectSmallSet>(property);
+        propertyValues->insert(value);
+    }
+}
+template <> void MObject::addALinkToMany<OrderedSet>(Property *property, MObject *value)
+{
+    if (value)
+    {
+        MObjectOrderedSet *propertyValues = getOrCreateLinkPropertyValue<MObjectOrderedSet>(property);
+        propertyValues->insert(value);
+    }
+}
+template <> void MObject::addALinkToMany<QMap, MapKey>(Property *property, MObject *value)
+{
+    if (value)
+    {
+        MObjectMap *propertyValues = getOrCreateLinkPropertyValue<MObjectMap>(property);
+        MapKey key = value->getPropertyMapKey(property);
+        propertyValues->insert(key, value);
+    }
+}
+template <> void MObject::addALinkToMany<QMultiMap, MapKey>(Property *property, MObject *value)
+{
+    if (value)
+    {
+        MObjectMultiMap *propertyValues = getOrCreateLinkPropertyValue<MObjectMultiMap>(property);
+        MapKey key = value->getPropertyMapKey(property);
+        propertyValues->insert(key, value);
+    }
 }
 
-
-QSet<LinkProperty*> MObject::getLinkProperties()
+// Template specializations of removeALinkFromMany for SmallSet, OrderedSet, QMap and QMultiMap
+template <> void MObject::removeALinkFromMany<SmallSet>(Property *property, MObject *value)
 {
-    QSet<LinkProperty*> linkProperties;
-    for (Property * property : _propertyValueMap.keys()){
-        if (property->isALinkProperty())
-            linkProperties.insert(static_cast<LinkProperty*>(property));
+    MObjectSmallSet *propertyValues = getLinkPropertyValue<MObjectSmallSet>(property);
+    if (value && propertyValues)
+    {
+        propertyValues->remove(value);
+    }
+}
+template <> void MObject::removeALinkFromMany<OrderedSet>(Property *property, MObject *value)
+{
+    MObjectOrderedSet *propertyValues = getLinkPropertyValue<MObjectOrderedSet>(property);
+    if (value && propertyValues)
+    {
+        propertyValues->remove(value);
+    }
+}
+template <> void MObject::removeALinkFromMany<QMap, MapKey>(Property *property, MObject *value)
+{
+    MObjectMap *propertyValues = getLinkPropertyValue<MObjectMap>(property);
+    if (value && propertyValues)
+    {
+        MapKey key = value->getPropertyMapKey(property);
+        propertyValues->remove(key);
+    }
+}
+template <> void MObject::removeALinkFromMany<QMultiMap, MapKey>(Property *property, MObject *value)
+{
+    MObjectMultiMap *propertyValues = getLinkPropertyValue<MObjectMultiMap>(property);
+    if (value && propertyValues)
+    {
+        MapKey key = value->getPropertyMapKey(property);
+        propertyValues->remove(key, value); // remove only the couple (key, value)
     }
-    return linkProperties;
 }
 
-QMap<QString, LinkProperty *> MObject::getContainmentProperties() const
+
+MapKey MObject::getPropertyMapKey(Property *mapProperty)
 {
-    QMap<QString, LinkProperty *> properties;
-    for (auto it = _propertyValueMap.cbegin(), itEnd = _propertyValueMap.cend() ; it != itEnd ; ++it)
+    if (mapProperty->isALinkProperty() && static_cast<LinkProperty*>(mapProperty)->isMapProperty())
     {
-        Property *property = it.key();
-        if (property->isEcoreContainment())
-            properties.insert(property->getName(), static_cast<LinkProperty*>(property));
+        Property *keyProperty = static_cast<MapLinkProperty*>(mapProperty)->getKey();
+        if (keyProperty)
+            return keyProperty->getMapKey(this);
     }
-    return properties;
+    return getName();
 }
 
-QMap<QString, Property *> MObject::getNonContainmentProperties() const
+void MObject::_updateMapKeys(Property *keyProperty, const MapKey &oldKey)
 {
-    QMap<QString, Property *> properties;
-    for (auto it = _propertyValueMap.cbegin(), itEnd = _propertyValueMap.cend() ; it != itEnd ; ++it)
+    // all the maps keyed by keyProperty share the same key
+    const MapKey newKey = keyProperty->getMapKey(this);
+    if (newKey == oldKey)
+        return;
+
+    for (MapLinkProperty *mapProperty : keyProperty->getPropertiesUsingAsKey())
     {
-        Property *property = it.key();
-        if (!property->isEcoreContainment() && property->isSerializable())
-            properties.insert(property->getName(), property);
+        // the MObjects having us in their map are the ones we link back to
+        // (without reverse link, only Model::rebuildMapProperty can do it)
+        LinkProperty *reverseProperty = mapProperty->getReverseLinkProperty();
+        if (!reverseProperty || !_propertyLayout->hasProperty(reverseProperty))
+            continue;
+
+        for (MObject *mapOwner : reverseProperty->getLinkedModelObjects(this))
+        {
+            MObjectMultiMap *map = mapProperty->getValues(mapOwner);
+            if (map->remove(oldKey, this))
+                map->insert(newKey, this);
+        }
     }
-    return properties;
 }
 
+
 void MObject::hideFromLinkedModelObjects()
 {
-    for (LinkProperty *linkProperty : getLinkProperties())
+    for (LinkProperty *linkProperty : _propertyLayout->getNonContainmentLinkProperties())
     {
-        if (!linkProperty->isEcoreContainment())
+        LinkProperty *reverseProperty = linkProperty->getReverseLinkProperty();
+        if (reverseProperty)
         {
-            LinkProperty *reverseProperty = linkProperty->getReverseLinkProperty();
-            if (reverseProperty)
-            {
-                for (MObject *linkedElem : linkProperty->getLinkedModelObjects(this))
-                    reverseProperty->removeLink(linkedElem, this);
-            }
+            for (MObject *linkedElem : linkProperty->getLinkedModelObjects(this))
+                reverseProperty->removeLink(linkedElem, this);
         }
     }
 }
 
 void MObject::makeVisibleForLinkedModelObjects()
 {
-    for (LinkProperty *linkProperty : getLinkProperties())
+    for (LinkProperty *linkProperty : _propertyLayout->getNonContainmentLinkProperties())
     {
-        if (!linkProperty->isEcoreContainment())
+        LinkProperty *reverseProperty = linkProperty->getReverseLinkProperty();
+        if (reverseProperty)
         {
-            LinkProperty *reverseProperty = linkProperty->getReverseLinkProperty();
-            if (reverseProperty)
-            {
-                for (MObject *linkedElem : linkProperty->getLinkedModelObjects(this))
-                    reverseProperty->addLink(linkedElem, this);
-            }
+            for (MObject *linkedElem : linkProperty->getLinkedModelObjects(this))
+                reverseProperty->addLink(linkedElem, this);
         }
     }
 }
@@ -208,27 +351,63 @@ void MObject::makeVisibleForLinkedModelObjects()
 
 MObject::MObject(QMap<QString, Property *> *classPropertyMap):
     _id(), _state(STATE::CREATED),
-    _isReadOnly(false), _isNameReadOnly(false),
-    _propertyValueMap()
+    _isReadOnly(false), _isNameReadOnly(false), _nbObservingModels(0),
+    _propertyLayout(PropertyLayout::getLayout(classPropertyMap)),
+    _propertyValues(), _rawPropertyValues(), _smallSetValues(),
+    _columnarStore(nullptr), _columnarRow(-1),
+    _arena(_arenaOf(this)),
+    _lazySource(nullptr), _lazyRecord(0), _hasLazyLinks(false)
+{
+    _initPropertyValues();
+}
+
+MObjectArena *MObject::_arenaOf(const void *ptr)
 {
-    _initPropertyValueMap(classPropertyMap);
+    // the MObjects on the stack or built in other memory (placement new...) are not in the arena even inside a Scope
+    MObjectArena *arena = MObjectArena::current();
+    return arena && arena->contains(ptr) ? arena : nullptr;
+}
+
+void *MObject::operator new(size_t size)
+{
+    MObjectArena *arena = MObjectArena::current();
+    return arena ? arena->allocate(size) : ::operator new(size);
+}
+
+void MObject::operator delete(void *ptr)
+{
+    if (!ptr)
+        return;
+
+    MObjectArena *arena = MObjectArena::owner(ptr); // whatever the thread, the Scope and the destructors run before
+    if (arena)
+        arena->deallocate(ptr);
+    else
+        ::operator delete(ptr);
 }
 
 MObject::~MObject()
 {
+    if (_columnarStore)
+        _columnarStore->detach(this);
+    if (_lazySource)
+    {
+        _hasLazyLinks = false; // no need to load them
+        _lazySource->detach(this, _lazyRecord);
+    }
+
 #ifdef __CASCADE_DELETION__
-    for (auto it = _propertyValueMap.begin(), itEnd = _propertyValueMap.end(); it != itEnd; ++it)
+    for (LinkProperty *linkProperty : _propertyLayout->getContainmentProperties())
     {
-        Property *property = it.key();
-        if (property->isALinkProperty() && property->isEcoreContainment())
-        {
-            LinkProperty *linkProperty = static_cast<LinkProperty*>(property);
-            for (MObject *containedObject : linkProperty->getLinkedModelObjects(this))
-                delete containedObject;
-        }
+        for (MObject *containedObject : linkProperty->getLinkedModelObjects(this))
+            delete containedObject;
     }
 #endif
 
+    // the link containers
+    for (LinkProperty *linkProperty : _propertyLayout->getLinkProperties())
+        linkProperty->deleteValue(this);
+
 // Hide from LinkedModelObject should be done in the Children destructor
 // as they may reimplement getPropertyMapKey
     //    hideFromLinkedModelObjects();
@@ -236,6 +415,7 @@ MObject::~MObject()
 
 MObject *MObject::clone(MObject *ecoreContainer, uint modelId, bool sameId)
 {
+    _loadLazyLinks();
     MObjectType *type = getModelObjectType();
     MObject *newModelObject = type->createModelObject(modelId);
 
@@ -246,20 +426,20 @@ MObject *MObject::clone(MObject *ecoreContainer, uint modelId, bool sameId)
         type->initModelObjectWithDefaultValues(newModelObject, modelId);
 qDebug() << "[MB_TRACE][MObject::clone] >>>>>>>>>> " << getName();
     // Copy the properties (deep copy)
-    for (auto it = _propertyValueMap.cbegin(), itEnd = _propertyValueMap.cend(); it != itEnd ; ++it)
+    for (Property *property : _propertyLayout->getProperties())
     {
-        Property *property = it.key();
 qDebug() << "[MB_TRACE][MObject::clone] - property: " << property->getName();
         if (property->isAttributeProperty())
-            newModelObject->setPropertyValueFromQVariant(property, it.value());
+            newModelObject->_copyAttributeValue(this, property);
         else
         {
             LinkProperty *linkProperty = static_cast<LinkProperty*>(property);
             if (linkProperty->isALinkToOneProperty())
             {
+                const QVariant &value = _value(property);
                 if (linkProperty->isEcoreContainment())
                 {
-                    MObject *linkedModelObject = static_cast<MObject*>(it.value().value<void*>());
+                    MObject *linkedModelObject = static_cast<MObject*>(value.value<void*>());
                     if (linkedModelObject)
                     {
                         linkedModelObject = linkedModelObject->clone(nullptr, modelId, sameId);
@@ -272,7 +452,7 @@ qDebug() << "[MB_TRACE][MObject::clone] - property: " << property->getName();
                         static_cast<LinkToOneProperty*>(linkProperty)->updateValue(newModelObject, ecoreContainer->toVariant());
                 }
                 else
-                    linkProperty->updateValue(newModelObject, it.value());
+                    linkProperty->updateValue(newModelObject, value);
             }
             else
             {
@@ -306,13 +486,10 @@ MObject *MObject::shallowCopy()
 
 void MObject::copyPropertiesFromSourceElementWithCloneElements(MObject *srcElem, Model *clonedModel)
 {
-    for (auto itProp = srcElem->_propertyValueMap.cbegin(), itPropEnd = srcElem->_propertyValueMap.cend(); itProp != itPropEnd ; ++itProp)
+    for (Property *property : srcElem->_propertyLayout->getProperties())
     {
-        Property *property = itProp.key();
-        QVariant valueCopy = itProp.value();
-
         if (property->isAttributeProperty())
-            _propertyValueMap[property] = valueCopy;
+            _copyAttributeValue(srcElem, property);
         else
         {
             LinkProperty *linkProperty      = static_cast<LinkProperty*>(property);
@@ -320,9 +497,9 @@ void MObject::copyPropertiesFromSourceElementWithCloneElements(MObject *srcElem,
             if (linkProperty->isMapProperty())
             {
                 MObjectMap clonedLinkedElemMap, *srcLinkedElemMap = linkProperty->getLinkedModelObjectsMap(srcElem);
-                for (const QVariant & key : srcLinkedElemMap->uniqueKeys())
+                for (const MapKey & key : srcLinkedElemMap->uniqueKeys())
                 {
-                    QVariant keyCopy     = key;
+                    MapKey keyCopy     = key;
                     MObjectList linkedElems = srcLinkedElemMap->values(key);
                     auto it = linkedElems.cend(), itStart = linkedElems.cbegin();
                     do
@@ -371,42 +548,32 @@ void MObject::serialize(XmiWriter *xmiWriter, const QString &tagName, const QStr
     xmiWriter->writeStartElement(tagName);
     if (!xmiType.isEmpty())
         xmiWriter->addAttribute("MObjectType", "Cosi7:" + xmiType);
-    xmiWriter->addAttribute("id", this->getId());
+    xmiWriter->addAttribute("id", this->getId().toString());
 
     // Non Containment / Container properties
-    auto itStart = _propertyValueMap.cbegin(), itEnd = _propertyValueMap.cend();
-    for (auto it = itStart ; it != itEnd; ++it)
-    {
-        Property *property = it.key();
-        if (property->isSerializable() && !property->isEcoreContainer() && !property->isEcoreContainment())
-            property->serializeAsXmiAttribute(xmiWriter, this);
-    }
+    for (Property *property : _propertyLayout->getXmiAttributeProperties())
+        property->serializeAsXmiAttribute(xmiWriter, this);
 
     // Now the Children (Containment)
-    for (auto it = itStart ; it != itEnd; ++it)
+    for (LinkProperty *linkProperty : _propertyLayout->getSerializableContainmentProperties())
     {
-        Property *property = it.key();
-        if ( property->isSerializable() && property->isEcoreContainment() )
+        bool specifyXmiType  = linkProperty->getLinkedModelObjectType()->isDerived();
+        QString childTagName = linkProperty->getName();
+        for (MObject *childElem : linkProperty->getLinkedModelObjects(this))
         {
-            LinkProperty *linkProperty = static_cast<LinkProperty*>(property);
-            bool specifyXmiType  = linkProperty->getLinkedModelObjectType()->isDerived();
-            QString childTagName = linkProperty->getName();
-            for (MObject *childElem : linkProperty->getLinkedModelObjects(this))
+            if (!childElem)
             {
-                if (!childElem)
-                {
-                    MObjectList list = linkProperty->getLinkedModelObjects(this);
-                    qDebug() << "[MB_TRACE][] ERROR: NULL childElem for childTagName" << childTagName
-                             << " elem: " << getName()  << ", nb in list: " << list.size();
+                MObjectList list = linkProperty->getLinkedModelObjects(this);
+                qDebug() << "[MB_TRACE][] ERROR: NULL childElem for childTagName" << childTagName
+                         << " elem: " << getName()  << ", nb in list: " << list.size();
 
-                }
+            }
+            else
+            {
+                if (specifyXmiType)
+                    childElem->serialize(xmiWriter, childTagName, childElem->getModelObjectTypeName());
                 else
-                {
-                    if (specifyXmiType)
-                        childElem->serialize(xmiWriter, childTagName, childElem->getModelObjectTypeName());
-                    else
-                        childElem->serialize(xmiWriter, childTagName);
-                }
+                    childElem->serialize(xmiWriter, childTagName);
             }
         }
     }
@@ -426,18 +593,14 @@ void MObject::exportWithLinksAsNewModelSharingSameModelObjects(Model *subModel,
         subModel->add(getModelObjectType(), this);
 
         // add recursively all its linked mObjects
-        for (Property *property : _propertyValueMap.keys())
+        // We only consider "real" link properties
+        // (we don't take the handy e-opposites aka not serializable properties)
+        for (LinkProperty *linkProperty : _propertyLayout->getSerializableLinkProperties())
         {
-            // We only consider "real" link properties
-            // (we don't take the handy e-opposites aka not serializable properties)
-            if (property->isALinkProperty() && property->isSerializable())
+            if (!onlyContainment || linkProperty->isEcoreContainment())
             {
-                if (!onlyContainment || property->isEcoreContainment())
-                {
-                    for (MObject *linkedModelObject : static_cast<LinkProperty*>(property)->getLinkedModelObjects(this) )
-                        linkedModelObject->exportWithLinksAsNewModelSharingSameModelObjects(subModel, rootTypesToNotTake);
-                }
-
+                for (MObject *linkedModelObject : linkProperty->getLinkedModelObjects(this) )
+                    linkedModelObject->exportWithLinksAsNewModelSharingSameModelObjects(subModel, rootTypesToNotTake);
             }
         }
     }
@@ -450,30 +613,24 @@ QIcon MObject::getIcon() {return QIcon();}
 
 MObject *MObject::getEcoreContainer() const
 {
-    for (auto it = _propertyValueMap.cbegin(), itEnd = _propertyValueMap.cend(); it != itEnd ; ++it)
-    {
-        Property *property = it.key();
-        if (property->isEcoreContainer())
-        { // Ecore Container property is a LinkToOneProperty
-            MObject *container = static_cast<MObject*>(it.value().value<void*>());
-            if (container)
-                return container;
-        }
+    _loadLazyLinks();
+    for (LinkProperty *property : _propertyLayout->getContainerProperties())
+    { // Ecore Container property is a LinkToOneProperty
+        MObject *container = static_cast<MObject*>(_value(property).value<void*>());
+        if (container)
+            return container;
     }
     return nullptr;
 }
 
 LinkToOneProperty *MObject::getEcoreContainerProperty() const
 {
-    for (auto it = _propertyValueMap.cbegin(), itEnd = _propertyValueMap.cend(); it != itEnd ; ++it)
-    {
-        Property *property = it.key();
-        if (property->isEcoreContainer())
-        { // Ecore Container property is a LinkToOneProperty
-            MObject *container = static_cast<MObject*>(it.value().value<void*>());
-            if (container)
-                return static_cast<LinkToOneProperty*>(property);
-        }
+    _loadLazyLinks();
+    for (LinkProperty *property : _propertyLayout->getContainerProperties())
+    { // Ecore Container property is a LinkToOneProperty
+        MObject *container = static_cast<MObject*>(_value(property).value<void*>());
+        if (container)
+            return static_cast<LinkToOneProperty*>(property);
     }
     return nullptr;
 }
@@ -486,45 +643,35 @@ void MObject::xmlExport(QXmlStreamWriter &xmlWriter)
     xmlWriter.writeStartElement(objTypeName);
 
     XmiWriter xmiWriter(nullptr, &xmlWriter);
-    auto itStart = _propertyValueMap.cbegin(), itEnd = _propertyValueMap.cend();
 
     // First the attribute properties
-    for (auto it = itStart; it != itEnd; ++it)
-    {
-        Property *property = it.key();
-        if (property->isAttributeProperty())
-            property->serializeAsXmiAttribute(&xmiWriter, this);
-    }
+    for (Property *property : _propertyLayout->getAttributeProperties())
+        property->serializeAsXmiAttribute(&xmiWriter, this);
 
     // Now link properties
-    for (auto it = itStart; it != itEnd; ++it)
+    for (LinkProperty *linkProperty : _propertyLayout->getSerializableLinkProperties())
     {
-        Property *property = it.key();
-        if (property->isALinkProperty() && property->isSerializable())
+        if (linkProperty->isEcoreContainer())
+            continue;
+        else
         {
-            LinkProperty *linkProperty = static_cast<LinkProperty*>(property);
-            if (linkProperty->isEcoreContainer())
-                continue;
+            QString propName(linkProperty->getName());
+            if (linkProperty->isEcoreContainment())
+            {
+                xmlWriter.writeStartElement(propName);
+                for (MObject *linkObj : linkProperty->getLinkedModelObjects(this, true))
+                    linkObj->xmlExport(xmlWriter);
+                xmlWriter.writeEndElement(); // propName
+            }
             else
             {
-                QString propName(linkProperty->getName());
-                if (linkProperty->isEcoreContainment())
+                for (MObject *linkObj : linkProperty->getLinkedModelObjects(this, true))
                 {
                     xmlWriter.writeStartElement(propName);
-                    for (MObject *linkObj : linkProperty->getLinkedModelObjects(this, true))
-                        linkObj->xmlExport(xmlWriter);
+                    xmlWriter.writeAttribute("type", linkObj->getModelObjectTypeName());
+                    xmlWriter.writeCharacters(linkObj->getName());
                     xmlWriter.writeEndElement(); // propName
                 }
-                else
-                {
-                    for (MObject *linkObj : linkProperty->getLinkedModelObjects(this, true))
-                    {
-                        xmlWriter.writeStartElement(propName);
-                        xmlWriter.writeAttribute("type", linkObj->getModelObjectTypeName());
-                        xmlWriter.writeCharacters(linkObj->getName());
-                        xmlWriter.writeEndElement(); // propName
-                    }
-                }
             }
         }
     }
@@ -536,13 +683,10 @@ void MObject::xmlExport(QXmlStreamWriter &xmlWriter)
 #include <QDomNode>
 void MObject::xmlImport(const QDomNode &node, Model *model, QList<MObjectLinkings *> *objectLinks)
 {
-    auto itStart = _propertyValueMap.cbegin(), itEnd = _propertyValueMap.cend();
-
     QDomElement elem = node.toElement();
     // First the attribute properties
-    for (auto it = itStart; it != itEnd; ++it)
+    for (Property *property : _propertyLayout->getProperties())
     {
-        Property *property = it.key();
         if (property->isAttributeProperty() && property != MObject::PROPERTY_NAME)
         {
             QString attrStr = elem.attribute(property->getName(), "").trimmed();
@@ -25,10 +25,18 @@
 
 #include "aliases.h"
 #include "MObjectType.h"
+#include "PropertyLayout.h"
+#include "PropertyRawValue.h"
+#include "ColumnarStore.h"
+#include "MObjectArena.h"
+#include "LazyModelSource.h"
+#include "SmallSet.h"
 #include <QSet>
 #include <QList>
 #include <QMap>
 #include <QMultiMap>
+#include <QVector>
+#include <new> // placement new (MObjectArena)
 
 class XmiWriter;
 class Model;
@@ -46,16 +54,18 @@ public:
     MObjectLinkings(MObject *const mObject, LinkProperty *const linkProperty, MObjectType *const linkedObjType, const QString &linkValue_):
         mObj(mObject), linkProp(linkProperty), linkedObjType(linkedObjType), linkValue(linkValue_) {}
 
-    MObject       *const mObj;
-    LinkProperty  *const linkProp;
-    MObjectType   *const linkedObjType;
-    const QString        linkValue;
+    // not const so they can be stored by value (cf XMIService::_linkModelObjects)
+    MObject      *mObj;
+    LinkProperty *linkProp;
+    MObjectType  *linkedObjType;
+    QString       linkValue;
 };
+Q_DECLARE_TYPEINFO(MObjectLinkings, Q_MOVABLE_TYPE);
 
 
 class MObject
 {
-    // Properties are Friend classes thus they can modify the _propertyValueMap using the corresponding adapted method to their type
+    // Properties are Friend classes thus they can modify the _propertyValues using the corresponding adapted method to their type
     // (setPropertyValueFromQVariant, setPropertyValueFromElement, ...
     // This is useful when using a property editor so the property can directly update the value of an MObject
     friend class Property;
@@ -66,6 +76,9 @@ class MObject
     template <template <typename...> class Container, typename... Args> friend class GenericLinkToManyProperty;
 
     friend class Model; // to be able to change the state of the MObject
+    friend class ColumnarStore; // to move the unboxed values in and out of the columns
+    friend class SnapshotService; // to read and write the unboxed values
+    friend class LazyModelSource; // to attach the MObjects it creates
 
 
     enum class STATE
@@ -81,10 +94,20 @@ private:
     STATE  _state;
     bool   _isReadOnly;
     bool   _isNameReadOnly;
+    quint16 _nbObservingModels; //!< Models holding the MObject that have observers (indexes, validation cache)
 
 
 protected:
-    QMap<Property*, QVariant> _propertyValueMap;
+    const PropertyLayout *const _propertyLayout; //!< shared by all the instances of the class
+    QVector<QVariant>           _propertyValues;    //!< indexed by Property::getSlot()
+    QVector<PropertyRawValue>   _rawPropertyValues; //!< unboxed properties (bool, int, float, double) indexed by Property::getSlot()
+    QVector<MObjectSmallSet>    _smallSetValues;    //!< LinkToManyProperty values (no allocation up to SmallSet::sInlineCapacity links) indexed by Property::getSlot()
+    ColumnarStore              *_columnarStore;     //!< when set, the unboxed values are in its columns (not in _rawPropertyValues)
+    int                         _columnarRow;
+    MObjectArena *const         _arena;             //!< where the MObject and its link containers are allocated (nullptr: not in an arena)
+    LazyModelSource            *_lazySource;        //!< when set, the MObject was created by it (cf Model::setLazySource)
+    uint                        _lazyRecord;        //!< index of the MObject in the _lazySource
+    bool                        _hasLazyLinks;      //!< its links are still in the _lazySource (loaded on the first access)
 
 public:
     static MObjectType*    TYPE;
@@ -106,6 +129,11 @@ public:
     MObject & operator=(const MObject& other) = delete;
     MObject & operator=(MObject&& other) = delete;
 
+    // in the MObjectArena of the current thread if any (cf MObjectArena::Scope), without header:
+    // operator delete finds the arena from the address (cf MObjectArena::owner)
+    static void *operator new(size_t size);
+    static void operator delete(void *ptr);
+
     MObject *clone(MObject *ecoreContainer, uint modelId, bool sameId);
 
     MObject *shallowCopy();
@@ -160,16 +188,17 @@ public:
 
     Property *getPropertyFromName(const QString &propertyName) const;
     inline QList<Property*> getPropertyList() const ;
-    QSet<LinkProperty*> getLinkProperties();
-    QMap<QString, LinkProperty *> getContainmentProperties() const;
-    QMap<QString, Property*> getNonContainmentProperties() const;
+    // precomputed by the PropertyLayout (no filtering nor allocation)
+    inline const QVector<LinkProperty*> &getLinkProperties() const;
+    inline const QMap<QString, LinkProperty *> &getContainmentProperties() const;
+    inline const QMap<QString, Property*> &getNonContainmentProperties() const;
 
 
 
     void hideFromLinkedModelObjects();
     void makeVisibleForLinkedModelObjects();
 
-    inline QVariant getPropertyVariant(Property *property) const;
+    QVariant getPropertyVariant(Property *property) const;
     MObject *getEcoreContainer() const;
     LinkToOneProperty *getEcoreContainerProperty() const;
 
@@ -189,7 +218,7 @@ public:
                                                           bool onlyContainment = false);//!< use to do some xml exports of the mObject with all the links needed
 
 
-    QVariant getPropertyMapKey(Property *mapProperty); //!< for non use of that function, we return the name by default
+    MapKey getPropertyMapKey(Property *mapProperty); //!< for non use of that function, we return the name by default
 
 #ifdef __USE_HMI__
     virtual QIcon getIcon();
@@ -205,13 +234,25 @@ protected:
 
 private:
 
-    void _initPropertyValueMap(QMap<QString, Property *> *classPropertyMap);
+    void _initPropertyValues();
+    // defined in Property.h (needs Property::getSlot)
+    inline const QVariant &_value(const Property *property) const;
+    inline QVariant &_value(const Property *property);
+    inline const PropertyRawValue &_rawValue(const Property *property) const;
+    inline PropertyRawValue &_rawValue(const Property *property);
+    inline const MObjectSmallSet &_smallSetValue(const Property *property) const;
+    inline void _loadLazyLinks() const; //!< before any access to the link values
+
+    static MObjectArena *_arenaOf(const void *ptr); //!< the arena of the current thread if it holds ptr
 
 
     // Those methods are shared with the Property classes
     template<typename TypeAttribute> TypeAttribute getPropertyValue(AttributeProperty<TypeAttribute> *property) const;
+    template<typename TypeAttribute> void setPropertyValue(AttributeProperty<TypeAttribute> *property, const TypeAttribute &value);
     template<typename TypeAttribute> QList<TypeAttribute> getListPropertyValue(AttributeListProperty<TypeAttribute> *property) const;
-    template<typename ReturnTypeLinkProperty> ReturnTypeLinkProperty *getLinkPropertyValue(Property *property) const;
+    template<typename ReturnTypeLinkProperty> ReturnTypeLinkProperty *getLinkPropertyValue(Property *property) const; //!< nullptr while the link is empty (except MObjectSmallSet)
+    template<typename ReturnTypeLinkProperty> ReturnTypeLinkProperty *getOrCreateLinkPropertyValue(Property *property); //!< allocated on first write (except MObjectSmallSet: inline)
+    template<typename ReturnTypeLinkProperty> void deleteLinkPropertyValue(Property *property);
 
     void setPropertyValueFromQVariant(Property *property, const QVariant &value);
     void setPropertyValueFromElement(LinkProperty *property, MObject *value);
@@ -221,6 +262,19 @@ private:
     // Those 2 functions will be specialized for each type but the template will be used by GenericLinkToManyProperty<Container, Args...>::addLink
     template <template <typename...> class Container, typename... Args> void addALinkToMany(Property *property, MObject *value);
     template <template <typename...> class Container, typename... Args> void removeALinkFromMany(Property *property, MObject *value);
+
+    // unboxed (std::true_type) or QVariant (std::false_type) storage of the AttributeProperty
+    template<typename TypeAttribute> TypeAttribute _getPropertyValue(AttributeProperty<TypeAttribute> *property, std::true_type) const;
+    template<typename TypeAttribute> TypeAttribute _getPropertyValue(AttributeProperty<TypeAttribute> *property, std::false_type) const;
+    template<typename TypeAttribute> void _setPropertyValue(AttributeProperty<TypeAttribute> *property, const TypeAttribute &value, std::true_type);
+    template<typename TypeAttribute> void _setPropertyValue(AttributeProperty<TypeAttribute> *property, const TypeAttribute &value, std::false_type);
+
+    void _copyAttributeValue(const MObject *srcElem, Property *property);
+
+    // move our entries in the maps of the MapLinkProperty using keyProperty as key (cf MapLinkProperty::setKey)
+    void _updateMapKeys(Property *keyProperty, const MapKey &oldKey);
+    PropertyRawValue _getRawValue(const Property *property) const; //!< from the ColumnarStore if any
+    void _setRawValue(const Property *property, const PropertyRawValue &rawValue);
 };
 
 
@@ -270,9 +324,21 @@ void MObject::setNameReadOnly(bool readOnly) { _isNameReadOnly = readOnly; }
 
 bool MObject::isA(MObjectType *type) const { return getModelObjectType()->isA(type); }
 
-QList<Property *> MObject::getPropertyList() const { return _propertyValueMap.keys(); }
+void MObject::_loadLazyLinks() const
+{
+    if (_hasLazyLinks)
+    {
+        MObject *mObject = const_cast<MObject*>(this); // the links are a cache of the source
+        mObject->_hasLazyLinks = false; // the source sets them through the LinkProperty
+        _lazySource->loadLinks(mObject, _lazyRecord);
+    }
+}
+
+QList<Property *> MObject::getPropertyList() const { return _propertyLayout->getProperties(); }
+const QVector<LinkProperty *> &MObject::getLinkProperties() const { return _propertyLayout->getLinkProperties(); }
+const QMap<QString, LinkProperty *> &MObject::getContainmentProperties() const { return _propertyLayout->getContainmentPropertyMap(); }
+const QMap<QString, Property *> &MObject::getNonContainmentProperties() const { return _propertyLayout->getNonContainmentPropertyMap(); }
 
-QVariant MObject::getPropertyVariant(Property *property) const { return _propertyValueMap.value(property, QVariant()); }
 
 
 bool MObject::operator<(MObject& elt){ return getId() < elt.getId(); }
@@ -302,108 +368,137 @@ template<typename ReturnTypeLinkProperty>
 void MObject::setLinkToManyPropertyValue(Property *property, ReturnTypeLinkProperty *value)
 {
     ReturnTypeLinkProperty *propertyValues = getLinkPropertyValue<ReturnTypeLinkProperty>(property);
+    if (!propertyValues)
+    {
+        if (value->isEmpty())
+            return;
+        propertyValues = getOrCreateLinkPropertyValue<ReturnTypeLinkProperty>(property);
+    }
     propertyValues->swap(*value);
 }
 
 template<typename ReturnTypeLinkProperty>
 ReturnTypeLinkProperty *MObject::getLinkPropertyValue(Property *property) const
 {
-    const QVariant &variant = _propertyValueMap[property];
+    _loadLazyLinks();
+    const QVariant &variant = _value(property);
     return static_cast<ReturnTypeLinkProperty*>(variant.value<void*>());
 }
 
-
-template<typename TypeAttribute>
-TypeAttribute MObject::getPropertyValue(AttributeProperty<TypeAttribute> *property) const
+template<typename ReturnTypeLinkProperty>
+ReturnTypeLinkProperty *MObject::getOrCreateLinkPropertyValue(Property *property)
 {
-    const QVariant &variant = _propertyValueMap[property];
-    return variant.value<TypeAttribute>();
+    ReturnTypeLinkProperty *propertyValues = getLinkPropertyValue<ReturnTypeLinkProperty>(property);
+    if (!propertyValues)
+    {
+        if (_arena)
+            propertyValues = new (_arena->allocate(sizeof(ReturnTypeLinkProperty))) ReturnTypeLinkProperty();
+        else
+            propertyValues = new ReturnTypeLinkProperty();
+        _value(property) = QVariant::fromValue(static_cast<void*>(propertyValues));
+    }
+    return propertyValues;
 }
 
-template<typename TypeAttribute>
-QList<TypeAttribute> MObject::getListPropertyValue(AttributeListProperty<TypeAttribute> *property) const
+template<typename ReturnTypeLinkProperty>
+void MObject::deleteLinkPropertyValue(Property *property)
 {
-    const QVariant &variant = _propertyValueMap[property];
-    return variant.value<QList<TypeAttribute> >();
-}
-
-
-
-/////////////////////////////////////////////////
-/// Template functions specializations (per type)
-/////////////////////////////////////////////////
+    ReturnTypeLinkProperty *propertyValues = getLinkPropertyValue<ReturnTypeLinkProperty>(property);
+    if (!propertyValues)
+        return;
 
-// Template specializations of addALinkToMany for QSet, QList, QMap and QMultiMap
-template <> inline void MObject::addALinkToMany<QSet>(Property *property, MObject *value)
-{
-    if (value)
+    if (_arena)
     {
-        MObjectSet *propertyValues = getLinkPropertyValue<MObjectSet>(property);
-        propertyValues->insert(value);
+        propertyValues->~ReturnTypeLinkProperty();
+        _arena->deallocate(propertyValues);
     }
+    else
+        delete propertyValues;
+    _value(property) = QVariant::fromValue(static_cast<void*>(nullptr));
 }
-template <> inline void MObject::addALinkToMany<QList>(Property *property, MObject *value)
+
+
+template<typename TypeAttribute>
+TypeAttribute MObject::getPropertyValue(AttributeProperty<TypeAttribute> *property) const
 {
-    if (value)
-    {
-        MObjectList *propertyValues = getLinkPropertyValue<MObjectList>(property);
-//        if (!propertyValues->contains(value))
-            propertyValues->append(value);
-    }
+    return _getPropertyValue(property, isUnboxedAttribute<TypeAttribute>());
 }
-template <> inline void MObject::addALinkToMany<QMap, QVariant>(Property *property, MObject *value)
+
+template<typename TypeAttribute>
+void MObject::setPropertyValue(AttributeProperty<TypeAttribute> *property, const TypeAttribute &value)
 {
-    if (value)
+    if (property->hasPropertiesUsingAsKey())
     {
-        MObjectMap *propertyValues = getLinkPropertyValue<MObjectMap>(property);
-        QVariant key = value->getPropertyMapKey(property);
-        propertyValues->insert(key, value);
+        const MapKey oldMapKey(_getPropertyValue(property, isUnboxedAttribute<TypeAttribute>()));
+        _setPropertyValue(property, value, isUnboxedAttribute<TypeAttribute>());
+        _updateMapKeys(property, oldMapKey);
     }
+    else
+        _setPropertyValue(property, value, isUnboxedAttribute<TypeAttribute>());
 }
-template <> inline void MObject::addALinkToMany<QMultiMap, QVariant>(Property *property, MObject *value)
+
+template<typename TypeAttribute>
+TypeAttribute MObject::_getPropertyValue(AttributeProperty<TypeAttribute> *property, std::true_type) const
 {
-    if (value)
-    {
-        MObjectMultiMap *propertyValues = getLinkPropertyValue<MObjectMultiMap>(property);
-        QVariant key = value->getPropertyMapKey(property);
-        propertyValues->insert(key, value);
-    }
+    if (_columnarStore)
+        return _columnarStore->getValue(property, _columnarRow);
+    else
+        return _rawValue(property).template get<TypeAttribute>();
 }
 
-// Template specializations of removeALinkFromMany2 for QSet, QList, QMap and QMultiMap
-template <> inline void MObject::removeALinkFromMany<QSet>(Property *property, MObject *value)
+template<typename TypeAttribute>
+TypeAttribute MObject::_getPropertyValue(AttributeProperty<TypeAttribute> *property, std::false_type) const
 {
-    if (value)
-    {
-        MObjectSet *propertyValues = getLinkPropertyValue<MObjectSet>(property);
-        propertyValues->remove(value);
-    }
+    const QVariant &variant = _value(property);
+    return variant.value<TypeAttribute>();
 }
-template <> inline void MObject::removeALinkFromMany<QList>(Property *property, MObject *value)
+
+template<typename TypeAttribute>
+void MObject::_setPropertyValue(AttributeProperty<TypeAttribute> *property, const TypeAttribute &value, std::true_type)
 {
-    if (value)
-    {
-        MObjectList *propertyValues = getLinkPropertyValue<MObjectList>(property);
-        propertyValues->removeOne(value);
-    }
+    if (_columnarStore)
+        _columnarStore->setValue(property, _columnarRow, value);
+    else
+        _rawValue(property).template set<TypeAttribute>(value);
+    property->notifyValueChanged(this);
 }
-template <> inline void MObject::removeALinkFromMany<QMap, QVariant>(Property *property, MObject *value)
+
+template<typename TypeAttribute>
+void MObject::_setPropertyValue(AttributeProperty<TypeAttribute> *property, const TypeAttribute &value, std::false_type)
 {
-    if (value)
-    {
-        MObjectMap *propertyValues = getLinkPropertyValue<MObjectMap>(property);
-        QVariant key = value->getPropertyMapKey(property);
-        propertyValues->remove(key);
-    }
+    _value(property) = QVariant::fromValue(value);
+    property->notifyValueChanged(this);
 }
-template <> inline void MObject::removeALinkFromMany<QMultiMap, QVariant>(Property *property, MObject *value)
+
+template<typename TypeAttribute>
+QList<TypeAttribute> MObject::getListPropertyValue(AttributeListProperty<TypeAttribute> *property) const
 {
-    if (value)
-    {
-        MObjectMultiMap *propertyValues = getLinkPropertyValue<MObjectMultiMap>(property);
-        QVariant key = value->getPropertyMapKey(property);
-        propertyValues->remove(key, value); // remove only the couple (key, value)
-    }
+    const QVariant &variant = _value(property);
+    return variant.value<QList<TypeAttribute> >();
 }
 
+
+
+/////////////////////////////////////////////////
+/// Template functions specializations (per type)
+/////////////////////////////////////////////////
+
+// Template specializations of addALinkToMany and removeALinkFromMany for SmallSet, OrderedSet, QMap and QMultiMap
+// (defined in MObject.cpp as they need the slot of the Property)
+template <> void MObject::addALinkToMany<SmallSet>(Property *property, MObject *value);
+template <> void MObject::addALinkToMany<OrderedSet>(Property *property, MObject *value);
+template <> void MObject::addALinkToMany<QMap, MapKey>(Property *property, MObject *value);
+template <> void MObject::addALinkToMany<QMultiMap, MapKey>(Property *property, MObject *value);
+
+template <> void MObject::removeALinkFromMany<SmallSet>(Property *property, MObject *value);
+template <> void MObject::removeALinkFromMany<OrderedSet>(Property *property, MObject *value);
+template <> void MObject::removeALinkFromMany<QMap, MapKey>(Property *property, MObject *value);
+template <> void MObject::removeALinkFromMany<QMultiMap, MapKey>(Property *property, MObject *value);
+
+// the MObjectSmallSet of the LinkToManyProperty are stored inline (cf _smallSetValues)
+// (defined in Property.h as they need the slot of the Property)
+template <> inline MObjectSmallSet *MObject::getLinkPropertyValue<MObjectSmallSet>(Property *property) const;
+template <> inline MObjectSmallSet *MObject::getOrCreateLinkPropertyValue<MObjectSmallSet>(Property *property);
+template <> inline void MObject::deleteLinkPropertyValue<MObjectSmallSet>(Property *property);
+
 #endif /* MOBJECT_H_ */
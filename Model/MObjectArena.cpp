@@ -0,0 +1,154 @@
+//========================================================================
+//
+// Copyright (C) 2018 Matthieu Bruel <Matthieu.Bruel@gmail.com>
+//
+// This file is a part of miniEMF++ : https://github.com/mbruel/miniEMF
+//
+// miniEMF++ is free software; you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as
+// published by the Free Software Foundation; version 3.0 of the License.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+// You should have received a copy of the GNU Lesser General Public
+// License along with this program; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301,
+// USA.
+//
+//========================================================================
+
+
+#include "MObjectArena.h"
+#include <cstdlib>
+#include <new>
+
+thread_local MObjectArena *MObjectArena::sCurrentArena = nullptr;
+
+QReadWriteLock                           MObjectArena::sBlockOwnersLock;
+QMap<quintptr, MObjectArena::BlockOwner> MObjectArena::sBlockOwners;
+QAtomicInt                               MObjectArena::sNbBlocks(0);
+
+const size_t MObjectArena::sDefaultBlockSize;
+const size_t MObjectArena::sAlignment;
+
+MObjectArena::Scope::Scope(MObjectArena *arena):
+    _previousArena(sCurrentArena)
+{
+    sCurrentArena = arena;
+}
+
+MObjectArena::Scope::~Scope()
+{
+    sCurrentArena = _previousArena;
+}
+
+
+MObjectArena::MObjectArena(size_t blockSize):
+    _blockSize(blockSize), _blocks(), _blockOffset(blockSize), _usedBytes(0), _nbAllocations(0), _isOrphan(false)
+{}
+
+MObjectArena::~MObjectArena()
+{
+    _freeBlocks();
+}
+
+void *MObjectArena::allocate(size_t size)
+{
+    size = (size + sAlignment - 1) & ~(sAlignment - 1);
+    char *ptr = nullptr;
+    if (size > _blockSize)
+    { // big enough to get its own block (inserted before the current one not to waste it)
+        ptr = _newBlock(size);
+        _blocks.insert(_blocks.isEmpty() ? 0 : _blocks.size() - 1, {ptr, size});
+    }
+    else
+    {
+        if (_blockOffset + size > _blockSize)
+        {
+            _blocks.append({_newBlock(_blockSize), _blockSize});
+            _blockOffset = 0;
+        }
+        ptr = _blocks.last().data + _blockOffset;
+        _blockOffset += size;
+    }
+    _usedBytes += size;
+    ++_nbAllocations;
+    return ptr;
+}
+
+bool MObjectArena::release()
+{
+    if (_nbAllocations)
+        return false;
+
+    _freeBlocks();
+    _blockOffset = _blockSize;
+    _usedBytes   = 0;
+    return true;
+}
+
+void MObjectArena::orphan()
+{
+    if (_nbAllocations)
+        _isOrphan = true;
+    else
+        delete this;
+}
+
+bool MObjectArena::contains(const void *ptr) const
+{
+    // the last block first: it is the one of the last allocations
+    quintptr address = reinterpret_cast<quintptr>(ptr);
+    for (int i = _blocks.size() - 1 ; i >= 0 ; --i)
+    {
+        const Block &block = _blocks.at(i);
+        if (address - reinterpret_cast<quintptr>(block.data) < block.size)
+            return true;
+    }
+    return false;
+}
+
+MObjectArena *MObjectArena::owner(const void *ptr)
+{
+    // a block holding a live allocation was registered before it: no arena block, no lock (the usual case)
+    if (sNbBlocks.loadAcquire() == 0)
+        return nullptr;
+
+    quintptr address = reinterpret_cast<quintptr>(ptr);
+    QReadLocker lock(&sBlockOwnersLock);
+    const QMap<quintptr, BlockOwner> &blockOwners = sBlockOwners; // no detach
+    auto it = blockOwners.upperBound(address); // the first block after ptr
+    if (it == blockOwners.cbegin())
+        return nullptr;
+    --it;
+    return address < it.value().end ? it.value().arena : nullptr;
+}
+
+char *MObjectArena::_newBlock(size_t size)
+{
+    char *block = static_cast<char*>(std::malloc(size));
+    if (!block)
+        throw std::bad_alloc();
+
+    QWriteLocker lock(&sBlockOwnersLock);
+    sBlockOwners.insert(reinterpret_cast<quintptr>(block), {reinterpret_cast<quintptr>(block) + size, this});
+    sNbBlocks.ref();
+    return block;
+}
+
+void MObjectArena::_freeBlocks()
+{
+    if (_blocks.isEmpty())
+        return;
+
+    QWriteLocker lock(&sBlockOwnersLock);
+    for (const Block &block : _blocks)
+    {
+        sBlockOwners.remove(reinterpret_cast<quintptr>(block.data));
+        sNbBlocks.deref();
+        std::free(block.data);
+    }
+    _blocks.clear();
+}
@@ -0,0 +1,134 @@
+//========================================================================
+//
+// Copyright (C) 2018 Matthieu Bruel <Matthieu.Bruel@gmail.com>
+//
+// This file is a part of miniEMF++ : https://github.com/mbruel/miniEMF
+//
+// miniEMF++ is free software; you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as
+// published by the Free Software Foundation; version 3.0 of the License.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+// You should have received a copy of the GNU Lesser General Public
+// License along with this program; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301,
+// USA.
+//
+//========================================================================
+
+#ifndef MOBJECTARENA_H
+#define MOBJECTARENA_H
+
+#include <QVector>
+#include <QMap>
+#include <QAtomicInt>
+#include <QReadWriteLock>
+#include <cstddef>
+
+/**
+ * @brief MObjectArena is a bump allocator for the MObjects of a Model and their link containers
+ *
+ * It is optional and owned by a Model (cf Model::enableArena).
+ * The MObjects created on a thread while a MObjectArena::Scope is alive are placed in its blocks
+ * (cf MObject::operator new), so are their link containers.
+ * The blocks of all the arenas are registered by address so a deletion finds its arena from any thread (cf owner).
+ * Deleting them only runs their destructor: the blocks are freed in bulk by release
+ * (done by Model::clearModel and ~Model once all the allocations are dead).
+ * If some allocations are still alive, the Model orphans the arena: it deletes itself with the last one.
+ * It is not thread safe: only the thread filling the Model should open a Scope.
+ */
+class MObjectArena
+{
+public:
+    //! MObjects created by the current thread go in the arena until the Scope is destroyed (nullptr: on the heap)
+    class Scope
+    {
+    public:
+        explicit Scope(MObjectArena *arena);
+        ~Scope();
+
+        Scope(const Scope &other) = delete;
+        Scope & operator=(const Scope &other) = delete;
+
+    private:
+        MObjectArena *const _previousArena;
+    };
+
+    explicit MObjectArena(size_t blockSize = sDefaultBlockSize);
+    ~MObjectArena();
+
+    MObjectArena(const MObjectArena &other) = delete;
+    MObjectArena(MObjectArena &&other) = delete;
+
+    MObjectArena & operator=(const MObjectArena &other) = delete;
+    MObjectArena & operator=(MObjectArena &&other) = delete;
+
+    void *allocate(size_t size); //!< aligned on sAlignment
+    inline void deallocate(void *ptr); //!< the memory is only given back by release (or with the last allocation of an orphan)
+    bool release(); //!< free all the blocks (only if all the allocations are dead)
+    void orphan();  //!< no more owner: delete the arena now or with its last allocation
+
+    bool contains(const void *ptr) const; //!< in one of its blocks
+    static MObjectArena *owner(const void *ptr); //!< the arena having ptr in its blocks (nullptr: not in an arena)
+
+    inline int    nbAllocations() const; //!< alive
+    inline int    nbBlocks() const;
+    inline size_t usedBytes() const;
+    inline size_t blockSize() const;
+
+    inline static MObjectArena *current(); //!< of the current thread (cf Scope)
+
+    static const size_t sDefaultBlockSize = 1 << 20;
+    static const size_t sAlignment        = alignof(std::max_align_t);
+
+private:
+    struct Block
+    {
+        char  *data;
+        size_t size;
+    };
+    struct BlockOwner
+    {
+        quintptr      end;
+        MObjectArena *arena;
+    };
+
+    char *_newBlock(size_t size); //!< registered in sBlockOwners
+    void _freeBlocks();
+
+    const size_t   _blockSize;
+    QVector<Block> _blocks;
+    size_t         _blockOffset; //!< used bytes of the last block
+    size_t         _usedBytes;
+    int            _nbAllocations;
+    bool           _isOrphan;
+
+    static thread_local MObjectArena *sCurrentArena;
+
+    static QReadWriteLock             sBlockOwnersLock;
+    static QMap<quintptr, BlockOwner> sBlockOwners; //!< the blocks of all the arenas by start address
+    static QAtomicInt                 sNbBlocks;    //!< owner doesn't lock while there is no arena block
+};
+
+
+////////////////////////////////
+/// inline functions definition
+////////////////////////////////
+void MObjectArena::deallocate(void *ptr)
+{
+    Q_UNUSED(ptr);
+    if (--_nbAllocations == 0 && _isOrphan)
+        delete this;
+}
+
+int    MObjectArena::nbAllocations() const { return _nbAllocations; }
+int    MObjectArena::nbBlocks()      const { return _blocks.size(); }
+size_t MObjectArena::usedBytes()     const { return _usedBytes; }
+size_t MObjectArena::blockSize()     const { return _blockSize; }
+
+MObjectArena *MObjectArena::current() { return sCurrentArena; }
+
+#endif // MOBJECTARENA_H
@@ -25,14 +25,19 @@
 #include "Model/Property.h"
 #include <QCoreApplication>
 #include <QRegularExpression>
+#include <algorithm>
 
 const QRegularExpression MObjectType::sElemIdTypeIdRegExp = QRegularExpression("^(\\d+)_(\\d*)_(\\d+)$");
+int    MObjectType::sNbTypes = 0;
+QMutex MObjectType::sFreezeMutex;
 
 MObjectType::MObjectType(int id, const QString &name, const char *label, ModelObjectCreator eltCreator, bool isInstanciable):
     _id(id), _name(name), _label(label), _isInstanciable(isInstanciable),
     _derivedModelObjectTypes(), _superModelObjectTypes(),
     _containerProperty(nullptr),
-    _elementCreator(eltCreator), _nbModelObjects(0)
+    _elementCreator(eltCreator), _nbModelObjects(0),
+    _typeIndex(sNbTypes++), _isFrozen(0), _ancestorBits(),
+    _derivedTypes(), _instanciableTypes(), _derivedTypeSet(), _instanciableTypeSet()
 {}
 
 MObjectType::~MObjectType() {}
@@ -41,26 +46,94 @@ QString MObjectType::getLabel() const { return QCoreApplication::translate("MObj
 
 QSet<MObjectType *> MObjectType::getDerivedModelObjectTypes()
 {
-    QSet<MObjectType *> derivedModelObjectTypes(_derivedModelObjectTypes);
-    for (MObjectType * mObjectType : _derivedModelObjectTypes)
+    _freezeIfNeeded();
+    return _derivedTypeSet;
+}
+
+QSet<MObjectType *> MObjectType::getInstanciableModelObjectTypes()
+{
+    _freezeIfNeeded();
+    return _instanciableTypeSet;
+}
+
+const QVector<MObjectType *> &MObjectType::getDerivedModelObjectTypesArray()
+{
+    _freezeIfNeeded();
+    return _derivedTypes;
+}
+
+const QVector<MObjectType *> &MObjectType::getInstanciableModelObjectTypesArray()
+{
+    _freezeIfNeeded();
+    return _instanciableTypes;
+}
+
+void MObjectType::freezeHierarchy()
+{
+    _derivedTypeSet.clear();
+    _collectDerivedTypes(_derivedTypeSet);
+
+    // sorted by id so that the scans of the derived types are deterministic
+    _derivedTypes.clear();
+    _derivedTypes.reserve(_derivedTypeSet.size());
+    for (MObjectType *mObjectType : _derivedTypeSet)
+        _derivedTypes.append(mObjectType);
+    std::sort(_derivedTypes.begin(), _derivedTypes.end(),
+              [](MObjectType *type1, MObjectType *type2){ return type1->_id < type2->_id; });
+
+    _instanciableTypes.clear();
+    _instanciableTypeSet.clear();
+    if (_isInstanciable)
+        _instanciableTypes.append(this);
+    for (MObjectType *mObjectType : _derivedTypes)
     {
-        if(mObjectType->isDerived())
-            derivedModelObjectTypes.unite(mObjectType->getDerivedModelObjectTypes());
+        if (mObjectType->_isInstanciable)
+            _instanciableTypes.append(mObjectType);
     }
+    for (MObjectType *mObjectType : _instanciableTypes)
+        _instanciableTypeSet.insert(mObjectType);
 
-    return derivedModelObjectTypes;
+    _ancestorBits.clear();
+    _collectAncestorBits(_ancestorBits);
+
+    _isFrozen.storeRelease(1);
 }
 
-QSet<MObjectType *> MObjectType::getInstanciableModelObjectTypes()
+void MObjectType::_collectDerivedTypes(QSet<MObjectType *> &derivedTypes) const
 {
-    QSet<MObjectType *> instanciableModelObjectTypes;
-    if (_isInstanciable)
-        instanciableModelObjectTypes.insert(this);
+    for (MObjectType *mObjectType : _derivedModelObjectTypes)
+    {
+        if (!derivedTypes.contains(mObjectType))
+        {
+            derivedTypes.insert(mObjectType);
+            mObjectType->_collectDerivedTypes(derivedTypes);
+        }
+    }
+}
 
-    for (MObjectType * mObjectType : _derivedModelObjectTypes)
-        instanciableModelObjectTypes.unite(mObjectType->getInstanciableModelObjectTypes());
+void MObjectType::_collectAncestorBits(QVector<quint64> &ancestorBits) const
+{
+    int word = _typeIndex >> 6;
+    if (word >= ancestorBits.size())
+        ancestorBits.resize(word + 1); // new words are set to 0
+    ancestorBits[word] |= Q_UINT64_C(1) << (_typeIndex & 63);
 
-    return instanciableModelObjectTypes;
+    for (MObjectType *superType : _superModelObjectTypes)
+        superType->_collectAncestorBits(ancestorBits);
+}
+
+void MObjectType::_unfreezeSuperTypes()
+{   // their derived closures change
+    _isFrozen.storeRelease(0);
+    for (MObjectType *superType : _superModelObjectTypes)
+        superType->_unfreezeSuperTypes();
+}
+
+void MObjectType::_unfreezeDerivedTypes()
+{   // their ancestors change
+    _isFrozen.storeRelease(0);
+    for (MObjectType *mObjectType : _derivedModelObjectTypes)
+        mObjectType->_unfreezeDerivedTypes();
 }
 
 QSet<MObjectType *> MObjectType::getSuperModelObjectTypes() { return _superModelObjectTypes; }
@@ -82,11 +155,13 @@ void MObjectType::addDerivedModelObjectType(MObjectType *eltType)
     {
         _derivedModelObjectTypes.insert(eltType);
         eltType->addSuperModelObjectType(this);
+        _unfreezeSuperTypes();
     }
 }
 
 void MObjectType::addSuperModelObjectType(MObjectType *superModelObjectType) {
     _superModelObjectTypes.insert(superModelObjectType);
+    _unfreezeDerivedTypes();
 }
 
 MObject *MObjectType::createModelObject(uint projectId, bool doDefaultInit, const QMap<Property *, QVariant> &properties)
@@ -96,7 +171,7 @@ MObject *MObjectType::createModelObject(uint projectId, bool doDefaultInit, cons
     else
     {
         MObject *mObject = _elementCreator();
-        mObject->setId(QString("%1_%2_%3").arg(getId()).arg(projectId).arg(++_nbModelObjects));
+        mObject->setId(ElemId(getId(), projectId, _nbModelObjects.fetchAndAddRelaxed(1) + 1));
 
         Property *containerProp = nullptr;
         for (auto it = properties.cbegin(), itEnd = properties.cend() ; it != itEnd ; ++it)
@@ -122,17 +197,28 @@ MObject *MObjectType::createModelObject(uint projectId, bool doDefaultInit, cons
 
 void MObjectType::initModelObjectWithDefaultValues(MObject *mObject, uint modelId)
 {
-    mObject->setId(QString("%1_%2_%3").arg(getId()).arg(modelId).arg(_nbModelObjects));
-    mObject->setName(QString("%1 %2").arg(getLabel()).arg(_nbModelObjects));
+    uint nbModelObjects = _nbModelObjects.loadRelaxed();
+    mObject->setId(ElemId(getId(), modelId, nbModelObjects));
+    mObject->setName(QString("%1 %2").arg(getLabel()).arg(nbModelObjects));
 }
 
 void MObjectType::updateMaxId(const ElemId &elemId)
 {
-    QRegularExpressionMatch match = sElemIdTypeIdRegExp.match(elemId);
-    if (match.hasMatch())
+    if (elemId.isPacked())
     {
-        uint typeId = match.captured(3).toUInt();
-        if (typeId > _nbModelObjects)
-            _nbModelObjects = typeId;
+        _raiseNbModelObjects(elemId.sequence());
+        return;
     }
+
+    // interned id (not in the packed form)
+    QRegularExpressionMatch match = sElemIdTypeIdRegExp.match(elemId.toString());
+    if (match.hasMatch())
+        _raiseNbModelObjects(match.captured(3).toUInt());
+}
+
+void MObjectType::_raiseNbModelObjects(uint nbModelObjects)
+{
+    uint current = _nbModelObjects.loadRelaxed();
+    while (nbModelObjects > current && !_nbModelObjects.testAndSetRelaxed(current, nbModelObjects))
+        current = _nbModelObjects.loadRelaxed();
 }
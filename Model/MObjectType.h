@@ -25,7 +25,10 @@
 #include <QString>
 #include <QMap>
 #include <QSet>
+#include <QVector>
 #include <QVariant>
+#include <QAtomicInteger>
+#include <QMutex>
 
 #include "aliases.h"
 class MObject;
@@ -52,12 +55,20 @@ public:
 
     QSet<MObjectType*> getDerivedModelObjectTypes();
     QSet<MObjectType*> getInstanciableModelObjectTypes();
+    const QVector<MObjectType*> &getDerivedModelObjectTypesArray();      //!< same as getDerivedModelObjectTypes (contiguous)
+    const QVector<MObjectType*> &getInstanciableModelObjectTypesArray(); //!< same as getInstanciableModelObjectTypes (contiguous)
     QSet<MObjectType*> getSuperModelObjectTypes();
     QSet<MObjectType*> getSuperInstanciableModelObjectTypes();
     void addDerivedModelObjectType(MObjectType* eltType);
     void addSuperModelObjectType(MObjectType* superModelObjectType);
 
-    inline bool isA(MObjectType *type) const;
+    inline bool isA(MObjectType *type) const; //!< constant time once the hierarchy is frozen
+
+    //! precompute the closures of the hierarchy (done by MObjectTypeFactory::initModelObjectTypes)
+    //! adding a super or derived type afterwards unfreezes the types impacted (they're frozen again on demand)
+    //! the hierarchy must not be modified while other threads use it (the freeze on demand is thread safe)
+    void freezeHierarchy();
+    inline bool isFrozen() const;
 
     inline LinkProperty *getContainerProperty() const;
     inline void setContainerProperty(LinkProperty *containerProperty);
@@ -83,7 +94,26 @@ private:
 
     const ModelObjectCreator _elementCreator;
 
-    uint _nbModelObjects;
+    QAtomicInteger<uint> _nbModelObjects; //!< atomic as the MObjects can be created by several threads (cf XMIService::loadXMIStream)
+
+    // closures of the hierarchy (cf freezeHierarchy)
+    const int             _typeIndex; //!< unique among all the MObjectTypes: bit of the type in the _ancestorBits
+    QAtomicInt            _isFrozen; //!< set last (release) so the readers that see it also see the closures
+    QVector<quint64>      _ancestorBits; //!< bitset of the _typeIndex of the type and all its super types
+    QVector<MObjectType*> _derivedTypes;
+    QVector<MObjectType*> _instanciableTypes;
+    QSet<MObjectType*>    _derivedTypeSet;
+    QSet<MObjectType*>    _instanciableTypeSet;
+
+    void _collectDerivedTypes(QSet<MObjectType*> &derivedTypes) const;
+    void _collectAncestorBits(QVector<quint64> &ancestorBits) const;
+    void _unfreezeSuperTypes();
+    void _unfreezeDerivedTypes();
+    inline void _freezeIfNeeded(); //!< from the getters, that can be called by concurrent readers
+    void _raiseNbModelObjects(uint nbModelObjects); //!< never decreases it (safe with concurrent creations)
+
+    static int    sNbTypes;
+    static QMutex sFreezeMutex; //!< only one freeze on demand at a time
 
     static const QRegularExpression sElemIdTypeIdRegExp;
 };
@@ -94,10 +124,27 @@ QString MObjectType::getName()        const { return _name; }
 bool    MObjectType::isInstanciable() const { return _isInstanciable;}
 bool    MObjectType::isDerived()      const { return !_derivedModelObjectTypes.isEmpty(); }
 
+bool MObjectType::isFrozen() const { return _isFrozen.loadAcquire(); }
+
+void MObjectType::_freezeIfNeeded()
+{
+    if (_isFrozen.loadAcquire())
+        return;
+
+    QMutexLocker lock(&sFreezeMutex);
+    if (!_isFrozen.loadAcquire()) // another reader may have frozen it meanwhile
+        freezeHierarchy();
+}
+
 bool MObjectType::isA(MObjectType *type) const
 {
     if (!type)
         return false;
+    else if (_isFrozen.loadAcquire())
+    {
+        int word = type->_typeIndex >> 6;
+        return word < _ancestorBits.size() && (_ancestorBits.at(word) >> (type->_typeIndex & 63)) & 1;
+    }
     else if (type == this || _superModelObjectTypes.contains(type))
         return true;
     else
@@ -114,7 +161,7 @@ bool MObjectType::isA(MObjectType *type) const
 LinkProperty *MObjectType::getContainerProperty() const { return _containerProperty; }
 void MObjectType::setContainerProperty(LinkProperty *containerProperty) { _containerProperty = containerProperty; }
 
-uint MObjectType::nbModelObjects() const { return _nbModelObjects; }
+uint MObjectType::nbModelObjects() const { return _nbModelObjects.loadRelaxed(); }
 
 #endif // ELEMENTTYPE_H
 
@@ -27,6 +27,10 @@ void MObjectTypeFactory::initModelObjectTypes()
 {
     defineDerivedModelObjectTypesFromEcore();
     _makeAllModelObjectTypeDeriveFromModelObject();
+
+    // the hierarchy won't change anymore
+    for (MObjectType *const mObjectType : _mObjectTypes)
+        mObjectType->freezeHierarchy();
 }
 
 MObjectType* MObjectTypeFactory::getModelObjectTypeById(int id)
@@ -0,0 +1,180 @@
+//========================================================================
+//
+// Copyright (C) 2018 Matthieu Bruel <Matthieu.Bruel@gmail.com>
+//
+// This file is a part of miniEMF++ : https://github.com/mbruel/miniEMF
+//
+// miniEMF++ is free software; you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as
+// published by the Free Software Foundation; version 3.0 of the License.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+// You should have received a copy of the GNU Lesser General Public
+// License along with this program; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301,
+// USA.
+//
+//========================================================================
+
+#ifndef MAPKEY_H
+#define MAPKEY_H
+
+#include <QString>
+#include <QVariant>
+#include <QDateTime>
+#include <QDebug>
+
+/**
+ * @brief MapKey is the key of the MObjectMap (cf MapLinkProperty::setKey)
+ *
+ * It is built straight from the typed value of the key attribute (cf Property::getMapKey)
+ * and stored natively in 16 bytes: the integers (and bool) as qint64, the floating points as double,
+ * the QDateTime as msecs since epoch and the QString as is (its d-pointer lives in the union).
+ * The keys of a map are expected to be of the same type (the keys of different types are ordered by type).
+ */
+class MapKey
+{
+public:
+    enum class TYPE : char {INVALID = 0, INTEGER, FLOATING, DATETIME, STRING};
+
+    inline MapKey();
+    inline MapKey(int value);
+    inline MapKey(uint value);
+    inline MapKey(qint64 value);
+    inline MapKey(double value);
+    inline MapKey(const QDateTime &value);
+    inline MapKey(const QString &value);
+
+    inline MapKey(const MapKey &other);
+    inline MapKey(MapKey &&other) noexcept;
+    inline ~MapKey();
+    inline MapKey &operator=(const MapKey &other);
+    inline MapKey &operator=(MapKey &&other) noexcept;
+
+    QVariant toVariant() const; //!< for display only
+
+    inline TYPE getType() const;
+    inline bool isValid() const;
+
+    inline bool operator==(const MapKey &other) const;
+    inline bool operator!=(const MapKey &other) const;
+    inline bool operator<(const MapKey &other) const;
+
+private:
+    inline void _copy(const MapKey &other);
+
+private:
+    TYPE _type;
+    union {
+        qint64  _integer;
+        double  _floating;
+        qint64  _msecs;
+        QString _string; //!< TYPE::STRING only
+    };
+};
+Q_DECLARE_TYPEINFO(MapKey, Q_MOVABLE_TYPE);
+static_assert(sizeof(MapKey) <= sizeof(qint64) + sizeof(QString), "MapKey should stay a tag and a single payload (16 bytes)");
+
+QDebug operator<<(QDebug debug, const MapKey &mapKey);
+
+
+////////////////////////////////
+/// inline functions definition
+////////////////////////////////
+MapKey::MapKey() : _type(TYPE::INVALID), _integer(0) {}
+MapKey::MapKey(int value) : MapKey(static_cast<qint64>(value)) {}
+MapKey::MapKey(uint value) : MapKey(static_cast<qint64>(value)) {}
+MapKey::MapKey(qint64 value) : _type(TYPE::INTEGER), _integer(value) {}
+MapKey::MapKey(double value) : _type(TYPE::FLOATING), _floating(value) {}
+MapKey::MapKey(const QDateTime &value) : _type(TYPE::DATETIME), _msecs(value.toMSecsSinceEpoch()) {}
+MapKey::MapKey(const QString &value) : _type(TYPE::STRING), _string(value) {}
+
+MapKey::MapKey(const MapKey &other) : _type(TYPE::INVALID), _integer(0) { _copy(other); }
+MapKey::MapKey(MapKey &&other) noexcept : _type(TYPE::INVALID), _integer(0)
+{
+    if (other._type == TYPE::STRING)
+    {
+        _type = TYPE::STRING;
+        new (&_string) QString(std::move(other._string));
+    }
+    else
+        _copy(other);
+}
+MapKey::~MapKey()
+{
+    if (_type == TYPE::STRING)
+        _string.~QString();
+}
+MapKey &MapKey::operator=(const MapKey &other)
+{
+    if (this != &other)
+        _copy(other);
+    return *this;
+}
+MapKey &MapKey::operator=(MapKey &&other) noexcept
+{
+    if (_type == TYPE::STRING && other._type == TYPE::STRING)
+        _string.swap(other._string);
+    else if (this != &other)
+        _copy(other);
+    return *this;
+}
+
+void MapKey::_copy(const MapKey &other)
+{
+    if (_type == TYPE::STRING && other._type == TYPE::STRING)
+    {
+        _string = other._string;
+        return;
+    }
+    if (_type == TYPE::STRING)
+        _string.~QString();
+    _type = other._type;
+    switch (_type)
+    {
+    case TYPE::FLOATING: _floating = other._floating; break;
+    case TYPE::DATETIME: _msecs    = other._msecs;    break;
+    case TYPE::STRING:   new (&_string) QString(other._string); break;
+    default:             _integer  = other._integer;
+    }
+}
+
+MapKey::TYPE MapKey::getType() const { return _type; }
+bool MapKey::isValid() const { return _type != TYPE::INVALID; }
+
+bool MapKey::operator==(const MapKey &other) const
+{
+    if (_type != other._type)
+        return false;
+
+    switch (_type)
+    {
+    case TYPE::INTEGER:  return _integer  == other._integer;
+    case TYPE::FLOATING: return _floating == other._floating;
+    case TYPE::DATETIME: return _msecs    == other._msecs;
+    case TYPE::STRING:   return _string   == other._string;
+    default:             return true;
+    }
+}
+
+bool MapKey::operator!=(const MapKey &other) const { return !(*this == other); }
+
+bool MapKey::operator<(const MapKey &other) const
+{
+    if (_type != other._type)
+        return _type < other._type;
+
+    switch (_type)
+    {
+    case TYPE::INTEGER:  return _integer  < other._integer;
+    case TYPE::FLOATING: return _floating < other._floating;
+    case TYPE::DATETIME: return _msecs    < other._msecs;
+    case TYPE::STRING:   return _string   < other._string;
+    default:             return false;
+    }
+}
+
+#endif // MAPKEY_H
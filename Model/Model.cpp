@@ -22,13 +22,15 @@
 #include "MObject.h"
 #include "Model.h"
 #include <QtDebug>
+#include <QStringList>
 #include "Model/MObjectTypeFactory.h"
+#include "Utils/Parallel.h"
 
 
 Model::Model(MObjectTypeFactory *typeFactory,
              const QString &dataModel, const QString &version, const QString &desc,
              uint id, const QString &date, bool ownElements):
-    _typeFactory(typeFactory), _mObjectTypeMap(), _nextElemId(), _ownModelObjects(ownElements),
+    _typeFactory(typeFactory), _mObjectTypeMap(), _mObjectIdIndex(), _nextElemId(), _columnarStores(), _nameIndex(nullptr), _attributeIndexes(), _validationCache(nullptr), _arena(nullptr), _lazySource(nullptr), _ownModelObjects(ownElements),
     _toolName(dataModel), _exportVersion(version), _exportDescription(desc), _id(id), _date(date)
 {
 }
@@ -36,13 +38,26 @@ Model::Model(MObjectTypeFactory *typeFactory,
 Model::Model(Model &&other):
     _typeFactory(other._typeFactory),
     _mObjectTypeMap(std::move(other._mObjectTypeMap)),
+    _mObjectIdIndex(std::move(other._mObjectIdIndex)),
     _nextElemId(std::move(other._nextElemId)),
+    _columnarStores(std::move(other._columnarStores)),
+    _nameIndex(other._nameIndex),
+    _attributeIndexes(std::move(other._attributeIndexes)),
+    _validationCache(other._validationCache),
+    _arena(other._arena),
+    _lazySource(other._lazySource),
     _ownModelObjects(other._ownModelObjects),
     _toolName(other._toolName), _exportVersion(other._exportVersion),
     _exportDescription(other._exportDescription),
     _id(other._id), _date(other._date)
 {
     other._ownModelObjects = false;
+    other._nameIndex       = nullptr;
+    other._validationCache = nullptr;
+    other._arena           = nullptr;
+    other._lazySource      = nullptr;
+    if (_lazySource)
+        _lazySource->_model = this;
 }
 
 //Model &Model::operator=(Model &&other)
@@ -66,6 +81,20 @@ Model::~Model()
 #else
     clearModel();
 #endif
+
+    // the MObjects we don't own are still there
+    if (_hasObservers())
+        _setModelObjectsObserved(false);
+    qDeleteAll(_columnarStores);
+    delete _nameIndex;
+    qDeleteAll(_attributeIndexes);
+    delete _validationCache;
+
+    if (_arena)
+    {
+        _releaseArena(); // we keep an empty one
+        delete _arena;
+    }
 }
 
 void Model::shallowCopySubsetOfMainModel(const MObjectSet &elementsToCopy, const QSet<MObjectType *> &rootTypesToNotTake, bool onlyContainment)
@@ -93,7 +122,7 @@ QString Model::getCopyName(MObject *mObjToCopy) const
     QString srcName = mObjToCopy->getName();
     int copyNumber = 0;
     const QRegularExpression copyReg(QString("^%1_copy(_(\\d+))?").arg(srcName));
-    QMap<QString, MObject*> *sameTypeElements = _mObjectTypeMap.value(mObjToCopy->getModelObjectType(), nullptr);
+    QMap<ElemId, MObject*> *sameTypeElements = _mObjectTypeMap.value(mObjToCopy->getModelObjectType(), nullptr);
     // we have at least one mObject, the one to copy so the Map exists
     for (auto it = sameTypeElements->cbegin(), itEnd = sameTypeElements->cend(); it != itEnd ; ++it)
     {
@@ -126,6 +155,8 @@ Model *Model::clone(Model *model)
     Model *clone = new Model(model->_typeFactory, model->_toolName, model->_exportVersion,
                              model->_exportDescription, model->_id, model->_date);
 
+    model->materializeAll();
+
     // clone all the mObjects without the property map
     auto itStart = model->_mObjectTypeMap.cbegin(), itEnd = model->_mObjectTypeMap.cend();
     for (auto itType = itStart ; itType != itEnd ; ++itType)
@@ -136,7 +167,11 @@ Model *Model::clone(Model *model)
         {
             QMap<ElemId, MObject*> *newModelObjects = new QMap<ElemId, MObject*>();
             for (auto itElem = mObjects->cbegin(), itElemEnd =  mObjects->cend(); itElem != itElemEnd ; ++itElem)
-               newModelObjects->insert(itElem.key(), itElem.value()->shallowCopy());
+            {
+                MObject *newModelObject = itElem.value()->shallowCopy();
+                newModelObjects->insert(itElem.key(), newModelObject);
+                clone->_mObjectIdIndex.insert(itElem.key(), newModelObject);
+            }
             clone->_mObjectTypeMap[type] = newModelObjects;
         }
     }
@@ -144,11 +179,11 @@ Model *Model::clone(Model *model)
     // Now update the property map
     for (MObjectType *type : model->_mObjectTypeMap.keys())
     {
-        QMap<QString, MObject*> *srcElements = model->_mObjectTypeMap.value(type),
+        QMap<ElemId, MObject*> *srcElements = model->_mObjectTypeMap.value(type),
                 *newModelObjects = clone->_mObjectTypeMap.value(type);
         if (!srcElements->isEmpty())
         {
-            for (const QString &elemId : srcElements->keys())
+            for (const ElemId &elemId : srcElements->keys())
             {
                 MObject *srcElem = srcElements->value(elemId),
                         *newModelObject = newModelObjects->value(elemId);
@@ -207,8 +242,22 @@ void Model::add(MObjectType *mObjectType, MObject *mObject, bool updateElemState
 {
     if (mObject)
     {
-        QMap<QString, MObject*> *mObjectMap = _getModelObjectMap(mObjectType);
-        (*mObjectMap)[mObject->getId()] =  mObject;
+        QMap<ElemId, MObject*> *mObjectMap = _getModelObjectMap(mObjectType);
+        MObject *&mapModelObject = (*mObjectMap)[mObject->getId()];
+        if (mapModelObject != mObject)
+        {
+            if (mapModelObject)
+                _unindexModelObject(mapModelObject);
+            mapModelObject = mObject;
+            _indexModelObject(mObject);
+        }
+
+        if (!_columnarStores.isEmpty())
+        {
+            ColumnarStore *columnarStore = _columnarStores.value(mObjectType, nullptr);
+            if (columnarStore)
+                columnarStore->attach(mObject);
+        }
 
         if (mObject->_state == MObject::STATE::REMOVED_FROM_MODEL)
             mObject->makeVisibleForLinkedModelObjects();
@@ -227,10 +276,16 @@ void Model::remove(MObject *mObject, bool hideFromOtherObjects)
 {
     if (mObject)
     {
-        QMap<QString, MObject*> *mObjectMap = _getModelObjectMap(mObject->getModelObjectType());
-        QMap<QString, MObject*>::iterator it = mObjectMap->find(mObject->getId());
+        QMap<ElemId, MObject*> *mObjectMap = _getModelObjectMap(mObject->getModelObjectType());
+        QMap<ElemId, MObject*>::iterator it = mObjectMap->find(mObject->getId());
         if (it != mObjectMap->end())
+        {
+            _unindexModelObject(it.value());
             mObjectMap->erase(it);
+        }
+
+        if (mObject->_columnarStore && mObject->_columnarStore == _columnarStores.value(mObject->getModelObjectType(), nullptr))
+            mObject->_columnarStore->detach(mObject);
 
         mObject->_state = MObject::STATE::REMOVED_FROM_MODEL;
         if (hideFromOtherObjects)
@@ -240,7 +295,7 @@ void Model::remove(MObject *mObject, bool hideFromOtherObjects)
 
 bool Model::contains(MObject *mObject)
 {
-    QMap<QString, MObject*> *map = _mObjectTypeMap.value(mObject->getModelObjectType(), nullptr);
+    QMap<ElemId, MObject*> *map = _mObjectTypeMap.value(mObject->getModelObjectType(), nullptr);
     if (map)
     {
         if (map->find(mObject->getId()) != map->cend())
@@ -251,30 +306,25 @@ bool Model::contains(MObject *mObject)
 
 
 
-MObject *Model::getModelObjectById(MObjectType* mObjectType, const QString &id)
+MObject *Model::getModelObjectById(MObjectType* mObjectType, const ElemId &id)
 {
-    QSet<MObjectType*> eltTypes(mObjectType->getInstanciableModelObjectTypes());
-    if (eltTypes.isEmpty())
+    // several MObjects can only share an id if they have different types
+    for (auto it = _mObjectIdIndex.constFind(id), itEnd = _mObjectIdIndex.constEnd(); it != itEnd && it.key() == id; ++it)
     {
-        qDebug() << "[ERROR][Model::getModelObjects] MObjectType '"
-                 << mObjectType->getName() << "' is not instanciable and has no derived class that is";
-    }
-
-    for (MObjectType * const eltType : eltTypes){
-        QMap<QString, MObject*> *mObjectMap = _mObjectTypeMap.value(eltType, nullptr);
-        if (mObjectMap){
-            auto it = mObjectMap->constFind(id);
-            if ( it != mObjectMap->constEnd())
-                return it.value();
-        }
+        MObject *mObject = it.value();
+        if (mObject->getModelObjectType()->isA(mObjectType))
+            return mObject;
     }
 
+    if (_lazySource) // it may not be created yet
+        return _lazySource->materializeModelObject(mObjectType, id);
     return nullptr;
 }
 
 MObject *Model::getModelObjectByName(MObjectType *mObjectType, const QString &name)
 {
-    QSet<MObjectType*> eltTypes(mObjectType->getInstanciableModelObjectTypes());
+    _materializeModelObjects(mObjectType, true);
+    const QVector<MObjectType*> &eltTypes = mObjectType->getInstanciableModelObjectTypesArray();
     if (eltTypes.isEmpty())
     {
         qDebug() << "[ERROR][Model::getModelObjects] MObjectType '"
@@ -282,7 +332,15 @@ MObject *Model::getModelObjectByName(MObjectType *mObjectType, const QString &na
     }
 
     for (MObjectType * const eltType : eltTypes){
-        QMap<QString, MObject*> *mObjectMap = _mObjectTypeMap.value(eltType, nullptr);
+        if (_nameIndex && _nameIndex->hasType(eltType))
+        {
+            MObject *mObject = _nameIndex->find(eltType, name);
+            if (mObject)
+                return mObject;
+            continue;
+        }
+
+        QMap<ElemId, MObject*> *mObjectMap = _mObjectTypeMap.value(eltType, nullptr);
         if (mObjectMap)
         {
             for (auto it = mObjectMap->cbegin() , itEnd = mObjectMap->cend(); it != itEnd ; ++it)
@@ -319,7 +377,7 @@ void Model::dumpModelObjectTypeMap(const QString &msg) const
     for (auto it = _mObjectTypeMap.cbegin(), itEnd = _mObjectTypeMap.cend(); it != itEnd; ++it)
     {
         MObjectType             *mObjectType = it.key();
-        QMap<QString, MObject*> *mObjectMap  = it.value();
+        QMap<ElemId, MObject*> *mObjectMap  = it.value();
         qDebug() << "\tNb " << mObjectType->getLabel() << " : " << mObjectMap->size()
                  << " (addr: " << mObjectType << ")";
     }
@@ -331,11 +389,14 @@ void Model::dumpModel(const QString &msg) const
     for (auto it = _mObjectTypeMap.cbegin(), itEnd = _mObjectTypeMap.cend(); it != itEnd; ++it)
     {
         MObjectType             *mObjectType = it.key();
-        QMap<QString, MObject*> *mObjectMap  = it.value();
+        QMap<ElemId, MObject*> *mObjectMap  = it.value();
         if (mObjectMap->size())
         {
+            QStringList ids;
+            for (const ElemId &elemId : mObjectMap->keys())
+                ids << elemId.toString();
             qDebug() << mObjectType->getName() << " : " << mObjectMap->size()
-                     << " ( " << mObjectMap->keys().join(", ") << " )";
+                     << " ( " << ids.join(", ") << " )";
         }
     }
 }
@@ -346,6 +407,9 @@ bool Model::operator ==(const Model &m)
     if (m._typeFactory != _typeFactory)
         return false;
 
+    materializeAll();
+    m.materializeAll();
+
     QList<MObjectType*> eltTypes = _mObjectTypeMap.keys();
     if (m._mObjectTypeMap.keys() != eltTypes)
         return false;
@@ -363,65 +427,352 @@ bool Model::operator ==(const Model &m)
 void Model::resetTypesNumberOfModelObjects()
 {
     for (auto itType = _mObjectTypeMap.cbegin(), itTypeEnd = _mObjectTypeMap.cend(); itType != itTypeEnd; ++itType)
-        itType.key()->_nbModelObjects = 0;
+        itType.key()->_nbModelObjects.storeRelaxed(0);
 }
 
 void Model::clearModel(bool deleteModelObjects)
 {
     if (_ownModelObjects)
     {
+        // the MObjects that are not deleted get back their values and are no more observed
+        for (ColumnarStore *columnarStore : _columnarStores)
+            columnarStore->detachAll();
+        if (_hasObservers())
+            _setModelObjectsObserved(false);
+        if (_nameIndex)
+            _nameIndex->clear();
+        for (AttributeIndex *index : _attributeIndexes)
+            index->clear();
+        if (_validationCache)
+            _validationCache->clear();
+
         auto itType = _mObjectTypeMap.begin(), itTypeEnd = _mObjectTypeMap.end();
         while (itType != itTypeEnd){
-            QMap<QString, MObject*> *mObjectMap = itType.value();
+            QMap<ElemId, MObject*> *mObjectMap = itType.value();
             if (deleteModelObjects)
                 qDeleteAll(*mObjectMap);
             delete mObjectMap;
             itType = _mObjectTypeMap.erase(itType);
         }
+        _mObjectIdIndex.clear();
     }
+
+    // the MObjects that are still alive lose the links not loaded yet
+    delete _lazySource;
+    _lazySource = nullptr;
+
+    if (_arena)
+        _releaseArena();
+}
+
+void Model::validate(QStringList &compilationErrors, const QSet<MObjectType *> &typesToExclude, bool inParallel)
+{
+    _validate(compilationErrors, &typesToExclude, true, true, inParallel);
 }
 
-void Model::validate(QStringList &compilationErrors, const QSet<MObjectType *> &typesToExclude)
+void Model::validateModel(QStringList &compilationErrors, bool inParallel)
 {
+    _validate(compilationErrors, nullptr, true, false, inParallel);
+}
+
+void Model::validateBusinessRules(QStringList &compilationErrors, const QSet<MObjectType *> &typesToExclude, bool inParallel)
+{
+    _validate(compilationErrors, &typesToExclude, false, true, inParallel);
+}
+
+void Model::incrementalValidate(QStringList &compilationErrors, const QSet<MObjectType *> &typesToExclude, bool inParallel)
+{
+    if (_validationCache && _validationCache->getTypesToExclude() != typesToExclude)
+        disableIncrementalValidation();
+
+    if (!_validationCache)
+    {
+        materializeAll();
+        bool hadObservers = _hasObservers();
+        _validationCache = new ValidationCache(typesToExclude);
+        for (auto itType = _mObjectTypeMap.cbegin(), itTypeEnd = _mObjectTypeMap.cend() ; itType != itTypeEnd ; ++itType)
+        {
+            for (MObject *mObject : *itType.value())
+                _validationCache->insert(mObject);
+        }
+        _updateObservedModelObjects(hadObservers);
+    }
+
+    _validationCache->validateDirtyModelObjects(inParallel);
+    _validationCache->getErrors(compilationErrors);
+}
+
+void Model::disableIncrementalValidation()
+{
+    bool hadObservers = _hasObservers();
+    delete _validationCache;
+    _validationCache = nullptr;
+    _updateObservedModelObjects(hadObservers);
+}
+
+const int Model::sValidationChunkSize;
+
+void Model::_validate(QStringList &compilationErrors, const QSet<MObjectType *> *typesToExclude,
+                      bool validateLinks, bool validateBusiness, bool inParallel)
+{
+    struct Chunk {
+        QMap<ElemId, MObject*>::const_iterator itBegin;
+        int  nbModelObjects;
+        bool validateBusiness;
+    };
+
+    materializeAll(); // no lazy loading from the threads
+
+    // cut the per type maps in chunks, in the order of the serial walk
+    QVector<Chunk> chunks;
     for (auto itType = _mObjectTypeMap.cbegin(), itTypeEnd = _mObjectTypeMap.cend() ; itType != itTypeEnd ; ++itType)
     {
-        QMap<QString, MObject*> *modelObjects = itType.value();
-        for (auto itObj = modelObjects->begin(), itObjEnd = modelObjects->end() ; itObj != itObjEnd ; ++itObj)
+        bool doBusiness = validateBusiness && !(typesToExclude && typesToExclude->contains(itType.key()));
+        if (!validateLinks && !doBusiness)
+            continue;
+
+        const QMap<ElemId, MObject*> *modelObjects = itType.value();
+        int objIdx = 0;
+        for (auto itObj = modelObjects->cbegin(), itObjEnd = modelObjects->cend() ; itObj != itObjEnd ; ++itObj, ++objIdx)
+        {
+            if (objIdx % sValidationChunkSize == 0)
+                chunks.append({itObj, qMin(modelObjects->size() - objIdx, sValidationChunkSize), doBusiness});
+        }
+    }
+
+    // each chunk has its own error list, merged in order at the end
+    QVector<QStringList> chunkErrors(chunks.size());
+    auto validateChunk = [&chunks, &chunkErrors, validateLinks](int chunkIdx){
+        const Chunk &chunk  = chunks.at(chunkIdx);
+        QStringList &errors = chunkErrors[chunkIdx];
+        auto itObj = chunk.itBegin;
+        for (int i = 0 ; i < chunk.nbModelObjects ; ++i, ++itObj)
         {
             MObject *modelObj = itObj.value();
-            modelObj->validateLinkProperties(compilationErrors);
-            if (!typesToExclude.contains(itType.key()))
-                modelObj->validateBusinessRules(compilationErrors);
+            if (validateLinks)
+                modelObj->validateLinkProperties(errors);
+            if (chunk.validateBusiness)
+                modelObj->validateBusinessRules(errors);
         }
+    };
+
+    if (inParallel && chunks.size() > 1)
+        Parallel::forEach(chunks.size(), validateChunk);
+    else
+    {
+        for (int chunkIdx = 0 ; chunkIdx < chunks.size() ; ++chunkIdx)
+            validateChunk(chunkIdx);
     }
+
+    for (const QStringList &errors : chunkErrors)
+        compilationErrors.append(errors);
 }
 
-void Model::validateModel(QStringList &compilationErrors)
+
+bool Model::enableColumnarStorage(MObjectType *mObjectType)
 {
-    for (auto itType = _mObjectTypeMap.cbegin(), itTypeEnd = _mObjectTypeMap.cend() ; itType != itTypeEnd ; ++itType)
+    if (!mObjectType->isInstanciable())
+    {
+        qCritical() << "[Model::enableColumnarStorage] ERROR: " << mObjectType->getName() << " is not instanciable";
+        return false;
+    }
+
+    if (!_columnarStores.contains(mObjectType))
+    {
+        ColumnarStore *columnarStore = new ColumnarStore(mObjectType);
+        _columnarStores.insert(mObjectType, columnarStore);
+        QMap<ElemId, MObject*> *mObjectMap = _mObjectTypeMap.value(mObjectType, nullptr);
+        if (mObjectMap)
+        {
+            for (MObject *mObj : *mObjectMap)
+                columnarStore->attach(mObj);
+        }
+    }
+    return true;
+}
+
+void Model::disableColumnarStorage(MObjectType *mObjectType)
+{
+    delete _columnarStores.take(mObjectType);
+}
+
+void Model::enableArena(size_t blockSize)
+{
+    if (!_arena)
+        _arena = new MObjectArena(blockSize);
+}
+
+void Model::_releaseArena()
+{
+    if (_arena->release())
+        return;
+
+    // the MObjects still alive (not deleted or not owned) keep their blocks:
+    // the arena is handed over to them (it is deleted with the last one) and we take a new one
+    MObjectArena *arena = new MObjectArena(_arena->blockSize());
+    _arena->orphan();
+    _arena = arena;
+}
+
+bool Model::setLazySource(LazyModelSource *lazySource)
+{
+    if (_lazySource)
+    {
+        qCritical() << "[Model::setLazySource] ERROR: the Model already has a LazyModelSource";
+        return false;
+    }
+
+    _lazySource = lazySource;
+    if (_lazySource)
+        _lazySource->_model = this;
+    return true;
+}
+
+void Model::materializeAll() const
+{
+    if (_lazySource)
+        _lazySource->materializeAll();
+}
+
+void Model::removeIndex(AttributeIndex *index)
+{
+    bool hadObservers = _hasObservers();
+    if (_attributeIndexes.removeOne(index))
+        delete index;
+    _updateObservedModelObjects(hadObservers);
+}
+
+AttributeIndex *Model::getIndex(MObjectType *mObjectType, Property *property, AttributeIndex::KIND kind) const
+{
+    for (AttributeIndex *index : _attributeIndexes)
     {
-        QMap<QString, MObject*> *modelObjects = itType.value();
-        for (auto itObj = modelObjects->begin(), itObjEnd = modelObjects->end() ; itObj != itObjEnd ; ++itObj)
-            itObj.value()->validateLinkProperties(compilationErrors);
+        if (index->getModelObjectType() == mObjectType && index->getProperty() == property && index->getKind() == kind)
+            return index;
     }
+    return nullptr;
 }
 
-void Model::validateBusinessRules(QStringList &compilationErrors, const QSet<MObjectType *> &typesToExclude)
+AttributeIndex *Model::_getIndexCovering(MObjectType *mObjectType, Property *property, bool ordered) const
+{
+    AttributeIndex *coveringIndex = nullptr;
+    for (AttributeIndex *index : _attributeIndexes)
+    {
+        if (index->getProperty() == property && mObjectType->isA(index->getModelObjectType())
+                && (!ordered || index->getKind() == AttributeIndex::KIND::ORDERED))
+        {
+            if (index->getModelObjectType() == mObjectType)
+                return index; // no need to filter its results
+            coveringIndex = index;
+        }
+    }
+    return coveringIndex;
+}
+
+void Model::_indexModelObject(MObject *mObject)
+{
+    _mObjectIdIndex.insert(mObject->getId(), mObject);
+    if (_nameIndex)
+        _nameIndex->insert(mObject);
+    for (AttributeIndex *index : _attributeIndexes)
+        index->insert(mObject);
+    if (_validationCache)
+        _validationCache->insert(mObject);
+    if (_hasObservers())
+        ++mObject->_nbObservingModels;
+}
+
+void Model::_unindexModelObject(MObject *mObject)
+{
+    _mObjectIdIndex.remove(mObject->getId(), mObject);
+    if (_nameIndex)
+        _nameIndex->remove(mObject);
+    for (AttributeIndex *index : _attributeIndexes)
+        index->remove(mObject);
+    if (_validationCache)
+        _validationCache->remove(mObject);
+    if (_hasObservers())
+        --mObject->_nbObservingModels;
+}
+
+void Model::_updateObservedModelObjects(bool hadObservers)
+{
+    bool hasObservers = _hasObservers();
+    if (hasObservers != hadObservers)
+        _setModelObjectsObserved(hasObservers);
+}
+
+void Model::_setModelObjectsObserved(bool observed)
 {
     for (auto itType = _mObjectTypeMap.cbegin(), itTypeEnd = _mObjectTypeMap.cend() ; itType != itTypeEnd ; ++itType)
     {
-        QMap<QString, MObject*> *modelObjects = itType.value();
-        for (auto itObj = modelObjects->begin(), itObjEnd = modelObjects->end() ; itObj != itObjEnd ; ++itObj)
+        for (MObject *mObject : *itType.value())
         {
-            if (!typesToExclude.contains(itType.key()))
-                itObj.value()->validateBusinessRules(compilationErrors);
+            if (observed)
+                ++mObject->_nbObservingModels;
+            else
+                --mObject->_nbObservingModels;
         }
     }
 }
 
+void Model::_keepModelObjectsOfType(MObjectList &mObjects, MObjectType *mObjectType)
+{
+    for (auto it = mObjects.begin(); it != mObjects.end(); )
+    {
+        if ((*it)->isA(mObjectType))
+            ++it;
+        else
+            it = mObjects.erase(it);
+    }
+}
+
+void Model::_sortModelObjectsById(MObjectList &mObjects)
+{
+    std::sort(mObjects.begin(), mObjects.end(), &MObject::elementIdLessThan);
+}
+
+void Model::enableNameIndex(MObjectType *mObjectType)
+{
+    bool hadObservers = _hasObservers();
+    if (!_nameIndex)
+        _nameIndex = new NameIndex();
+
+    _materializeModelObjects(mObjectType, true);
+    for (MObjectType *eltType : mObjectType->getInstanciableModelObjectTypesArray())
+    {
+        QMap<ElemId, MObject*> *mObjectMap = _mObjectTypeMap.value(eltType, nullptr);
+        _nameIndex->addType(eltType, mObjectMap ? mObjectMap->values() : QList<MObject*>());
+    }
+    _updateObservedModelObjects(hadObservers);
+}
+
+void Model::disableNameIndex(MObjectType *mObjectType)
+{
+    if (!_nameIndex)
+        return;
+
+    for (MObjectType *eltType : mObjectType->getInstanciableModelObjectTypesArray())
+        _nameIndex->removeType(eltType);
+
+    if (_nameIndex->isEmpty())
+    {
+        delete _nameIndex;
+        _nameIndex = nullptr;
+        _updateObservedModelObjects(true);
+    }
+}
+
+QVector<MObjectType *> Model::_getInstanciableTypes(MObjectType *mObjectType, bool useDerivedType) const
+{
+    if (useDerivedType)
+        return mObjectType->getInstanciableModelObjectTypesArray();
+    else
+        return {mObjectType};
+}
 
 MObjectSet Model::getModelObjects(MObjectType* mObjectType, bool useDerivedType, MObjectSet* filterModelObjects)
 {
+    _materializeModelObjects(mObjectType, useDerivedType);
     QSet<MObjectType*> eltTypes = {mObjectType};
 
     if (useDerivedType)
@@ -435,7 +786,7 @@ MObjectSet Model::getModelObjects(MObjectType* mObjectType, bool useDerivedType,
     MObjectSet mObjects;
     for (MObjectType *eltType : eltTypes)
     {
-        QMap<QString, MObject*>* mObjectMap = _mObjectTypeMap.value(eltType, nullptr);
+        QMap<ElemId, MObject*>* mObjectMap = _mObjectTypeMap.value(eltType, nullptr);
 #ifdef __MB_TRACE_MODEL__
         if (!mObjectMap)
         {
@@ -460,6 +811,7 @@ MObjectSet Model::getModelObjects(MObjectType* mObjectType, bool useDerivedType,
 
 QMap<ElemId, MObject *> Model::getModelObjectsAsMap(MObjectType *mObjectType, bool useDerivedType, MObjectSet *filterModelObjects)
 {
+    _materializeModelObjects(mObjectType, useDerivedType);
     QSet<MObjectType*> eltTypes = {mObjectType};
 
     if (useDerivedType)
@@ -473,7 +825,7 @@ QMap<ElemId, MObject *> Model::getModelObjectsAsMap(MObjectType *mObjectType, bo
     QMap<ElemId, MObject *> resMap;
     for (MObjectType *eltType : eltTypes)
     {
-        QMap<QString, MObject*>* mObjectMap = _mObjectTypeMap.value(eltType, nullptr);
+        QMap<ElemId, MObject*>* mObjectMap = _mObjectTypeMap.value(eltType, nullptr);
 #ifdef __MB_TRACE_MODEL__
         if (!mObjectMap)
         {
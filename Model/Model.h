@@ -23,8 +23,18 @@
 #define MODEL_H
 
 #include "aliases.h"
+#include "ColumnarStore.h"
+#include "NameIndex.h"
+#include "AttributeIndex.h"
+#include "ModelObjectView.h"
+#include "ValidationCache.h"
+#include "MObjectArena.h"
+#include "LazyModelSource.h"
 
 #include <QSet>
+#include <QMap>
+#include <QMultiHash>
+#include <QVector>
 
 
 class MObject;
@@ -36,12 +46,21 @@ class Model
 {
     friend class XmiWriter; // to access _typeFactory
     friend class XMIService; // for exports
+    friend class PropertyAggregator; // for _getInstanciableTypes
+    friend class ModelObjectView;    // to iterate _mObjectTypeMap
 
 
 private:  
     MObjectTypeFactory *_typeFactory;
     QMap<MObjectType*, QMap<ElemId, MObject*>* > _mObjectTypeMap;
+    QMultiHash<ElemId, MObject*> _mObjectIdIndex; //!< all the MObjects of _mObjectTypeMap by id (cf getModelObjectById)
     QMap<MObjectType*, uint> _nextElemId;
+    QMap<MObjectType*, ColumnarStore*> _columnarStores; //!< optional (cf enableColumnarStorage)
+    NameIndex *_nameIndex; //!< optional (cf enableNameIndex)
+    QList<AttributeIndex*> _attributeIndexes; //!< optional (cf createHashIndex and createOrderedIndex)
+    ValidationCache *_validationCache; //!< optional (cf incrementalValidate)
+    MObjectArena *_arena; //!< optional (cf enableArena)
+    LazyModelSource *_lazySource; //!< optional (cf setLazySource)
 
     bool          _ownModelObjects; //!< set to false for subModels, no destuction of the ELements in destructor
 
@@ -79,19 +98,79 @@ public:
     bool contains(MObject *mObject);
 
     void resetTypesNumberOfModelObjects();
+    //! the indexes, the validation cache and the columnar stores are emptied but kept for the next MObjects
+    //! (the pointers given by createHashIndex, createOrderedIndex and getColumnarStore stay valid)
     void clearModel(bool deleteModelObjects = true);
 
-    void validate(QStringList &compilationErrors, const QSet<MObjectType*> &typesToExclude = QSet<MObjectType*>());
-    void validateModel(QStringList &compilationErrors);
-    void validateBusinessRules(QStringList &compilationErrors, const QSet<MObjectType*> &typesToExclude = QSet<MObjectType*>());
+    // inParallel: chunks of MObjects are validated on the global QThreadPool
+    // the errors are in the same order than in a serial run
+    void validate(QStringList &compilationErrors, const QSet<MObjectType*> &typesToExclude = QSet<MObjectType*>(), bool inParallel = false);
+    void validateModel(QStringList &compilationErrors, bool inParallel = false);
+    void validateBusinessRules(QStringList &compilationErrors, const QSet<MObjectType*> &typesToExclude = QSet<MObjectType*>(), bool inParallel = false);
+
+    // the first call validates all the MObjects, the next ones only the MObjects changed since (and their linked MObjects)
+    // the errors are the same than validate
+    void incrementalValidate(QStringList &compilationErrors, const QSet<MObjectType*> &typesToExclude = QSet<MObjectType*>(), bool inParallel = false);
+    void disableIncrementalValidation();
 
     MObjectSet getModelObjects(MObjectType *mObjectType, bool useDerivedType = false, MObjectSet *filterModelObjects = nullptr);
+    inline ModelObjectView getModelObjectsView(MObjectType *mObjectType, bool useDerivedType = false) const; //!< without copy
     QMap<ElemId, MObject *> getModelObjectsAsMap(MObjectType *mObjectType, bool useDerivedType = false, MObjectSet *filterModelObjects = nullptr);
-    MObject        *getModelObjectById(MObjectType *mObjectType, const QString &id);
+    MObject        *getModelObjectById(MObjectType *mObjectType, const ElemId &id);
+    inline MObject *getModelObjectById(MObjectType *mObjectType, const QString &id); //!< legacy string form (XMI)
     MObject        *getModelObjectByName(MObjectType *mObjectType, const QString &name);
 
+    // #### Name index (used by getModelObjectByName) ####
+    void enableNameIndex(MObjectType *mObjectType); //!< for all its instanciable types
+    void disableNameIndex(MObjectType *mObjectType);
+    inline bool hasNameIndex(MObjectType *mObjectType) const; //!< for an instanciable type
+
+    // #### Secondary indexes on the AttributeProperty (on a type and its derived types) ####
+    template<typename TypeAttribute> HashAttributeIndex<TypeAttribute> *createHashIndex(MObjectType *mObjectType, AttributeProperty<TypeAttribute> *property);
+    template<typename TypeAttribute> OrderedAttributeIndex<TypeAttribute> *createOrderedIndex(MObjectType *mObjectType, AttributeProperty<TypeAttribute> *property);
+    void removeIndex(AttributeIndex *index);
+    AttributeIndex *getIndex(MObjectType *mObjectType, Property *property, AttributeIndex::KIND kind) const;
+
+    //! MObjects of the type (and derived) having the value, sorted by id (using an index if any)
+    template<typename TypeAttribute>
+    MObjectList findModelObjects(MObjectType *mObjectType, AttributeProperty<TypeAttribute> *property, const TypeAttribute &value) const;
+
+    //! MObjects of the type (and derived) with lowerBound <= value <= upperBound, sorted by value (using an ordered index if any)
+    template<typename TypeAttribute>
+    MObjectList findModelObjectsInRange(MObjectType *mObjectType, AttributeProperty<TypeAttribute> *property,
+                                        const TypeAttribute &lowerBound, const TypeAttribute &upperBound) const;
+
     MObjectList getModelObjectsOrderedByNames(MObjectType *mObjectType, bool useDerivedType = false, MObjectSet *filterModelObjects = nullptr);
 
+
+    // #### Columnar storage of the unboxed attributes (bool, int, float, double) ####
+    bool enableColumnarStorage(MObjectType *mObjectType); //!< only for instanciable types
+    void disableColumnarStorage(MObjectType *mObjectType);
+    inline ColumnarStore *getColumnarStore(MObjectType *mObjectType) const;
+
+    // #### Arena of the MObjects (freed in bulk by clearModel, or with the last MObject still alive) ####
+    //! the MObjects are only placed in it inside a MObjectArena::Scope (XMIService::loadXMI opens one)
+    void enableArena(size_t blockSize = MObjectArena::sDefaultBlockSize);
+    inline MObjectArena *getArena() const;
+
+    // #### Lazy materialization of the MObjects (cf LazyModelSource) ####
+    //! the Model takes the ownership of the source (only one per Model, cf SnapshotService::openSnapshot)
+    bool setLazySource(LazyModelSource *lazySource);
+    inline LazyModelSource *getLazySource() const;
+    void materializeAll() const; //!< create all the MObjects still in the source (if any)
+
+    //! contiguous values of the property for the MObjects of the type (nullptr if it doesn't use a ColumnarStore)
+    template<typename TypeAttribute> const QVector<TypeAttribute> *getColumn(MObjectType *mObjectType, AttributeProperty<TypeAttribute> *property) const;
+
+    //! call function(value) for the MObjects of the type (scanning the columns if the type uses a ColumnarStore)
+    template<typename TypeAttribute, typename Function>
+    void forEachValue(MObjectType *mObjectType, AttributeProperty<TypeAttribute> *property, Function function, bool useDerivedType = false) const;
+
+    //! call function(mObject) without building any intermediate container
+    template<typename Function>
+    void forEachModelObject(MObjectType *mObjectType, Function function, bool useDerivedType = false) const;
+
+
     inline QList<MObjectType*> getModelObjectTypes() const;
     QList<MObjectType*> getRootModelObjectTypes();
     MObjectType *getModelObjectTypeByName(const QString &name);
@@ -114,11 +193,62 @@ private:
 
     void rebuildMapProperty(MapLinkProperty *mapProp);
 
+    QVector<MObjectType*> _getInstanciableTypes(MObjectType *mObjectType, bool useDerivedType) const;
+    inline void _materializeModelObjects(MObjectType *mObjectType, bool useDerivedType) const; //!< before iterating on the type
+
+    // keep the indexes up to date (id, name and attributes)
+    void _indexModelObject(MObject *mObject);
+    void _unindexModelObject(MObject *mObject);
+
+    // only the MObjects of the Models having observers notify their changes (cf Property::notifyValueChanged)
+    inline bool _hasObservers() const;
+    void _updateObservedModelObjects(bool hadObservers); //!< after adding or removing an observer
+    void _setModelObjectsObserved(bool observed);
+
+    void _releaseArena(); //!< free its blocks or hand it over to the MObjects still alive
+
+    //! index on the property for a super type of mObjectType (preferably mObjectType itself)
+    AttributeIndex *_getIndexCovering(MObjectType *mObjectType, Property *property, bool ordered) const;
+    static void _keepModelObjectsOfType(MObjectList &mObjects, MObjectType *mObjectType);
+    static void _sortModelObjectsById(MObjectList &mObjects);
+
+    static const int sValidationChunkSize = 512; //!< MObjects validated by one task
+    void _validate(QStringList &compilationErrors, const QSet<MObjectType*> *typesToExclude,
+                   bool validateLinks, bool validateBusiness, bool inParallel);
+
     typedef bool (*SortElementView)(MObject*, MObject*);
     static QList<MObject *> _convertAndSortQSetToQList(const MObjectSet &elts, SortElementView sortFunction);
 };
 
-QList<MObjectType *> Model::getModelObjectTypes() const { return _mObjectTypeMap.keys(); }
+QList<MObjectType *> Model::getModelObjectTypes() const
+{
+    materializeAll(); // the types of the MObjects still in the source
+    return _mObjectTypeMap.keys();
+}
+
+MObject *Model::getModelObjectById(MObjectType *mObjectType, const QString &id) { return getModelObjectById(mObjectType, ElemId::fromString(id)); }
+
+ModelObjectView Model::getModelObjectsView(MObjectType *mObjectType, bool useDerivedType) const
+{
+    _materializeModelObjects(mObjectType, useDerivedType);
+    return ModelObjectView(this, mObjectType, useDerivedType);
+}
+
+bool Model::hasNameIndex(MObjectType *mObjectType) const { return _nameIndex && _nameIndex->hasType(mObjectType); }
+
+ColumnarStore *Model::getColumnarStore(MObjectType *mObjectType) const { return _columnarStores.value(mObjectType, nullptr); }
+MObjectArena *Model::getArena() const { return _arena; }
+LazyModelSource *Model::getLazySource() const { return _lazySource; }
+bool Model::_hasObservers() const { return _nameIndex || !_attributeIndexes.isEmpty() || _validationCache; }
+
+void Model::_materializeModelObjects(MObjectType *mObjectType, bool useDerivedType) const
+{
+    if (_lazySource)
+    {
+        for (MObjectType *eltType : _getInstanciableTypes(mObjectType, useDerivedType))
+            _lazySource->materializeModelObjects(eltType);
+    }
+}
 
 QString Model::getDate() const { return _date; }
 QString Model::getExportDescription() const { return _exportDescription; }
@@ -126,4 +256,140 @@ QString Model::getExportVersion() const { return _exportVersion; }
 QString Model::getToolName() const { return _toolName; }
 uint Model::getId() const { return _id; }
 
+
+////////////////////////////////////////////
+/// Template functions definition (generic)
+////////////////////////////////////////////
+template<typename TypeAttribute>
+const QVector<TypeAttribute> *Model::getColumn(MObjectType *mObjectType, AttributeProperty<TypeAttribute> *property) const
+{
+    ColumnarStore *columnarStore = _columnarStores.value(mObjectType, nullptr);
+    if (columnarStore)
+        return columnarStore->getColumn(property);
+    else
+        return nullptr;
+}
+
+template<typename TypeAttribute, typename Function>
+void Model::forEachValue(MObjectType *mObjectType, AttributeProperty<TypeAttribute> *property, Function function, bool useDerivedType) const
+{
+    _materializeModelObjects(mObjectType, useDerivedType);
+    for (MObjectType *eltType : _getInstanciableTypes(mObjectType, useDerivedType))
+    {
+        const QVector<TypeAttribute> *column = getColumn(eltType, property);
+        if (column)
+        {
+            for (const TypeAttribute &value : *column)
+                function(value);
+        }
+        else
+        {
+            QMap<ElemId, MObject*> *mObjectMap = _mObjectTypeMap.value(eltType, nullptr);
+            if (mObjectMap)
+            {
+                for (MObject *mObj : *mObjectMap)
+                    function(property->getValue(mObj));
+            }
+        }
+    }
+}
+
+template<typename TypeAttribute>
+HashAttributeIndex<TypeAttribute> *Model::createHashIndex(MObjectType *mObjectType, AttributeProperty<TypeAttribute> *property)
+{
+    HashAttributeIndex<TypeAttribute> *index =
+            static_cast<HashAttributeIndex<TypeAttribute>*>(getIndex(mObjectType, property, AttributeIndex::KIND::HASH));
+    if (!index)
+    {
+        index = new HashAttributeIndex<TypeAttribute>(mObjectType, property);
+        forEachModelObject(mObjectType, [index](MObject *mObj){ index->insert(mObj); }, true);
+        bool hadObservers = _hasObservers();
+        _attributeIndexes.append(index);
+        _updateObservedModelObjects(hadObservers);
+    }
+    return index;
+}
+
+template<typename TypeAttribute>
+OrderedAttributeIndex<TypeAttribute> *Model::createOrderedIndex(MObjectType *mObjectType, AttributeProperty<TypeAttribute> *property)
+{
+    OrderedAttributeIndex<TypeAttribute> *index =
+            static_cast<OrderedAttributeIndex<TypeAttribute>*>(getIndex(mObjectType, property, AttributeIndex::KIND::ORDERED));
+    if (!index)
+    {
+        index = new OrderedAttributeIndex<TypeAttribute>(mObjectType, property);
+        forEachModelObject(mObjectType, [index](MObject *mObj){ index->insert(mObj); }, true);
+        bool hadObservers = _hasObservers();
+        _attributeIndexes.append(index);
+        _updateObservedModelObjects(hadObservers);
+    }
+    return index;
+}
+
+template<typename TypeAttribute>
+MObjectList Model::findModelObjects(MObjectType *mObjectType, AttributeProperty<TypeAttribute> *property, const TypeAttribute &value) const
+{
+    MObjectList mObjects;
+    AttributeIndex *index = _getIndexCovering(mObjectType, property, false);
+    if (index)
+    {
+        if (index->getKind() == AttributeIndex::KIND::HASH)
+            mObjects = static_cast<HashAttributeIndex<TypeAttribute>*>(index)->find(value);
+        else
+            mObjects = static_cast<OrderedAttributeIndex<TypeAttribute>*>(index)->find(value);
+        if (index->getModelObjectType() != mObjectType)
+            _keepModelObjectsOfType(mObjects, mObjectType);
+    }
+    else
+    {
+        forEachModelObject(mObjectType, [&mObjects, property, &value](MObject *mObj){
+            if (property->getValue(mObj) == value)
+                mObjects.append(mObj);
+        }, true);
+        _sortModelObjectsById(mObjects);
+    }
+    return mObjects;
+}
+
+template<typename TypeAttribute>
+MObjectList Model::findModelObjectsInRange(MObjectType *mObjectType, AttributeProperty<TypeAttribute> *property,
+                                           const TypeAttribute &lowerBound, const TypeAttribute &upperBound) const
+{
+    MObjectList mObjects;
+    AttributeIndex *index = _getIndexCovering(mObjectType, property, true);
+    if (index)
+    {
+        mObjects = static_cast<OrderedAttributeIndex<TypeAttribute>*>(index)->findInRange(lowerBound, upperBound);
+        if (index->getModelObjectType() != mObjectType)
+            _keepModelObjectsOfType(mObjects, mObjectType);
+    }
+    else
+    {
+        QMultiMap<TypeAttribute, MObject*> sortedModelObjects;
+        forEachModelObject(mObjectType, [&sortedModelObjects, property, &lowerBound, &upperBound](MObject *mObj){
+            TypeAttribute value = property->getValue(mObj);
+            if (!(value < lowerBound) && !(upperBound < value))
+                sortedModelObjects.insert(value, mObj);
+        }, true);
+        for (auto it = sortedModelObjects.cbegin(), itEnd = sortedModelObjects.cend(); it != itEnd; ++it)
+            mObjects.append(it.value());
+    }
+    return mObjects;
+}
+
+template<typename Function>
+void Model::forEachModelObject(MObjectType *mObjectType, Function function, bool useDerivedType) const
+{
+    _materializeModelObjects(mObjectType, useDerivedType);
+    for (MObjectType *eltType : _getInstanciableTypes(mObjectType, useDerivedType))
+    {
+        QMap<ElemId, MObject*> *mObjectMap = _mObjectTypeMap.value(eltType, nullptr);
+        if (mObjectMap)
+        {
+            for (MObject *mObj : *mObjectMap)
+                function(mObj);
+        }
+    }
+}
+
 #endif // MODEL_H
@@ -0,0 +1,152 @@
+//========================================================================
+//
+// Copyright (C) 2018 Matthieu Bruel <Matthieu.Bruel@gmail.com>
+//
+// This file is a part of miniEMF++ : https://github.com/mbruel/miniEMF
+//
+// miniEMF++ is free software; you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as
+// published by the Free Software Foundation; version 3.0 of the License.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+// You should have received a copy of the GNU Lesser General Public
+// License along with this program; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301,
+// USA.
+//
+//========================================================================
+
+#include "ModelObjectView.h"
+#include "Model.h"
+#include "MObjectType.h"
+
+ModelObjectView::ModelObjectView(const Model *model, MObjectType *mObjectType, bool useDerivedType, const Predicate &predicate):
+    _model(model), _mObjectType(mObjectType), _useDerivedType(useDerivedType),
+    _typesBegin(nullptr), _typesEnd(nullptr), _predicate(predicate)
+{
+    _initTypes();
+}
+
+ModelObjectView::ModelObjectView(const ModelObjectView &other):
+    _model(other._model), _mObjectType(other._mObjectType), _useDerivedType(other._useDerivedType),
+    _typesBegin(nullptr), _typesEnd(nullptr), _predicate(other._predicate)
+{
+    _initTypes();
+}
+
+ModelObjectView &ModelObjectView::operator=(const ModelObjectView &other)
+{
+    _model          = other._model;
+    _mObjectType    = other._mObjectType;
+    _useDerivedType = other._useDerivedType;
+    _predicate      = other._predicate;
+    _initTypes();
+    return *this;
+}
+
+void ModelObjectView::_initTypes()
+{
+    if (_useDerivedType)
+    {
+        const QVector<MObjectType*> &eltTypes = _mObjectType->getInstanciableModelObjectTypesArray();
+        _typesBegin = eltTypes.constData();
+        _typesEnd   = eltTypes.constData() + eltTypes.size();
+    }
+    else
+    {   // the type itself
+        _typesBegin = &_mObjectType;
+        _typesEnd   = &_mObjectType + 1;
+    }
+}
+
+ModelObjectView ModelObjectView::filter(const Predicate &predicate) const
+{
+    if (!_predicate)
+        return ModelObjectView(_model, _mObjectType, _useDerivedType, predicate);
+
+    Predicate currentPredicate = _predicate;
+    return ModelObjectView(_model, _mObjectType, _useDerivedType, [currentPredicate, predicate](MObject *mObj){
+        return currentPredicate(mObj) && predicate(mObj);
+    });
+}
+
+ModelObjectView ModelObjectView::exclude(const MObjectSet *excludedModelObjects) const
+{
+    if (!excludedModelObjects || excludedModelObjects->isEmpty())
+        return *this;
+    else
+        return filter([excludedModelObjects](MObject *mObj){ return !excludedModelObjects->contains(mObj); });
+}
+
+MObject *ModelObjectView::first() const
+{
+    const_iterator it = begin();
+    return it != end() ? *it : nullptr;
+}
+
+int ModelObjectView::count() const
+{
+    int nbModelObjects = 0;
+    for (auto it = begin(), itEnd = end(); it != itEnd; ++it)
+        ++nbModelObjects;
+    return nbModelObjects;
+}
+
+MObjectSet ModelObjectView::toSet() const
+{
+    MObjectSet mObjects;
+    for (MObject *mObj : *this)
+        mObjects.insert(mObj);
+    return mObjects;
+}
+
+MObjectList ModelObjectView::toList() const
+{
+    MObjectList mObjects;
+    for (MObject *mObj : *this)
+        mObjects.append(mObj);
+    return mObjects;
+}
+
+
+ModelObjectView::const_iterator::const_iterator(const ModelObjectView *view, MObjectType *const *itType):
+    _view(view), _itType(itType), _itObj(), _itObjEnd()
+{
+    if (_itType != _view->_typesEnd)
+    {
+        _loadType();
+        _skipFiltered();
+    }
+}
+
+void ModelObjectView::const_iterator::_loadType()
+{
+    QMap<ElemId, MObject*> *mObjectMap = _view->_model->_mObjectTypeMap.value(*_itType, nullptr);
+    if (mObjectMap)
+    {
+        _itObj    = mObjectMap->cbegin();
+        _itObjEnd = mObjectMap->cend();
+    }
+    else
+        _itObj = _itObjEnd = QMap<ElemId, MObject*>::const_iterator();
+}
+
+void ModelObjectView::const_iterator::_skipFiltered()
+{
+    while (true)
+    {
+        for ( ; _itObj != _itObjEnd ; ++_itObj)
+        {
+            if (_view->_accept(_itObj.value()))
+                return;
+        }
+
+        // next type
+        if (++_itType == _view->_typesEnd)
+            return;
+        _loadType();
+    }
+}
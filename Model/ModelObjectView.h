@@ -0,0 +1,135 @@
+//========================================================================
+//
+// Copyright (C) 2018 Matthieu Bruel <Matthieu.Bruel@gmail.com>
+//
+// This file is a part of miniEMF++ : https://github.com/mbruel/miniEMF
+//
+// miniEMF++ is free software; you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as
+// published by the Free Software Foundation; version 3.0 of the License.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+// You should have received a copy of the GNU Lesser General Public
+// License along with this program; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301,
+// USA.
+//
+//========================================================================
+
+#ifndef MODELOBJECTVIEW_H
+#define MODELOBJECTVIEW_H
+
+#include "aliases.h"
+#include <QMap>
+#include <functional>
+
+class Model;
+class MObjectType;
+
+/**
+ * @brief ModelObjectView iterates the MObjects of a type (and its derived types) in a Model
+ * without copying them in a container (cf Model::getModelObjectsView)
+ *
+ * The MObjects are visited type per type, by id. They can be filtered by predicates,
+ * the iteration can be stopped at any time (break in a range-based for loop).
+ * The view and its iterators must not be used after a change of the Model (add / remove)
+ * and the iterators are only valid while their view exists.
+ */
+class ModelObjectView
+{
+public:
+    using Predicate = std::function<bool(MObject*)>;
+
+    class const_iterator
+    {
+    public:
+        using iterator_category = std::forward_iterator_tag;
+        using value_type        = MObject*;
+        using difference_type   = std::ptrdiff_t;
+        using pointer           = MObject* const*;
+        using reference         = MObject* const&;
+
+        inline MObject *operator*() const;
+        inline const_iterator &operator++();
+        inline bool operator==(const const_iterator &other) const;
+        inline bool operator!=(const const_iterator &other) const;
+
+    private:
+        friend class ModelObjectView;
+        const_iterator(const ModelObjectView *view, MObjectType *const *itType);
+
+        void _loadType();      //!< position on the first MObject of *_itType
+        void _skipFiltered();  //!< go to the next MObject accepted by the predicate (or to the end)
+
+        const ModelObjectView                   *_view;
+        MObjectType *const                      *_itType;
+        QMap<ElemId, MObject*>::const_iterator   _itObj;
+        QMap<ElemId, MObject*>::const_iterator   _itObjEnd;
+    };
+
+    ModelObjectView(const Model *model, MObjectType *mObjectType, bool useDerivedType = false,
+                    const Predicate &predicate = Predicate());
+    ~ModelObjectView() = default;
+
+    ModelObjectView(const ModelObjectView &other);
+    ModelObjectView & operator=(const ModelObjectView &other);
+
+    inline const_iterator begin() const;
+    inline const_iterator end() const;
+
+    //! view on the MObjects of this view that also satisfy the predicate
+    ModelObjectView filter(const Predicate &predicate) const;
+
+    //! view without the MObjects of the set (as the filterModelObjects of Model::getModelObjects)
+    ModelObjectView exclude(const MObjectSet *excludedModelObjects) const;
+
+    inline bool isEmpty() const;
+    MObject *first() const; //!< nullptr if empty
+    int count() const;
+
+    MObjectSet  toSet() const;
+    MObjectList toList() const;
+
+private:
+    const Model        *_model;
+    MObjectType        *_mObjectType;
+    bool                _useDerivedType;
+    MObjectType *const *_typesBegin; //!< frozen instanciable types or &_mObjectType
+    MObjectType *const *_typesEnd;
+    Predicate           _predicate;
+
+    void _initTypes();
+    inline bool _accept(MObject *mObject) const;
+};
+
+
+////////////////////////////////
+/// inline functions definition
+////////////////////////////////
+MObject *ModelObjectView::const_iterator::operator*() const { return _itObj.value(); }
+
+ModelObjectView::const_iterator &ModelObjectView::const_iterator::operator++()
+{
+    ++_itObj;
+    _skipFiltered();
+    return *this;
+}
+
+bool ModelObjectView::const_iterator::operator==(const const_iterator &other) const
+{
+    return _itType == other._itType && (_itType == _view->_typesEnd || _itObj == other._itObj);
+}
+
+bool ModelObjectView::const_iterator::operator!=(const const_iterator &other) const { return !(*this == other); }
+
+ModelObjectView::const_iterator ModelObjectView::begin() const { return const_iterator(this, _typesBegin); }
+ModelObjectView::const_iterator ModelObjectView::end() const { return const_iterator(this, _typesEnd); }
+
+bool ModelObjectView::isEmpty() const { return begin() == end(); }
+
+bool ModelObjectView::_accept(MObject *mObject) const { return !_predicate || _predicate(mObject); }
+
+#endif // MODELOBJECTVIEW_H
@@ -0,0 +1,122 @@
+//========================================================================
+//
+// Copyright (C) 2018 Matthieu Bruel <Matthieu.Bruel@gmail.com>
+//
+// This file is a part of miniEMF++ : https://github.com/mbruel/miniEMF
+//
+// miniEMF++ is free software; you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as
+// published by the Free Software Foundation; version 3.0 of the License.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+// You should have received a copy of the GNU Lesser General Public
+// License along with this program; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301,
+// USA.
+//
+//========================================================================
+
+#include "NameIndex.h"
+#include "MObject.h"
+#include "Property.h"
+
+NameIndex::NameIndex():
+    _typeIndexes(), _indexedNames()
+{
+    MObject::PROPERTY_NAME->addObserver(this);
+}
+
+NameIndex::~NameIndex()
+{
+    MObject::PROPERTY_NAME->removeObserver(this);
+}
+
+void NameIndex::addType(MObjectType *mObjectType, const QList<MObject *> &mObjects)
+{
+    if (_typeIndexes.contains(mObjectType))
+        return;
+
+    QMultiHash<QString, MObject*> &typeIndex = _typeIndexes[mObjectType];
+    typeIndex.reserve(mObjects.size());
+    for (MObject *mObject : mObjects)
+    {
+        QString name = mObject->getName();
+        typeIndex.insert(name, mObject);
+        _indexedNames.insert(mObject, name);
+    }
+}
+
+void NameIndex::removeType(MObjectType *mObjectType)
+{
+    auto it = _typeIndexes.find(mObjectType);
+    if (it != _typeIndexes.end())
+    {
+        for (MObject *mObject : it.value())
+            _indexedNames.remove(mObject);
+        _typeIndexes.erase(it);
+    }
+}
+
+void NameIndex::insert(MObject *mObject)
+{
+    auto it = _typeIndexes.find(mObject->getModelObjectType());
+    if (it != _typeIndexes.end() && !_indexedNames.contains(mObject))
+    {
+        QString name = mObject->getName();
+        it.value().insert(name, mObject);
+        _indexedNames.insert(mObject, name);
+    }
+}
+
+void NameIndex::remove(MObject *mObject)
+{
+    auto itName = _indexedNames.find(mObject);
+    if (itName != _indexedNames.end())
+    {
+        _typeIndexes[mObject->getModelObjectType()].remove(itName.value(), mObject);
+        _indexedNames.erase(itName);
+    }
+}
+
+void NameIndex::clear()
+{
+    for (QMultiHash<QString, MObject*> &typeIndex : _typeIndexes)
+        typeIndex.clear();
+    _indexedNames.clear();
+}
+
+MObject *NameIndex::find(MObjectType *mObjectType, const QString &name) const
+{
+    MObject *mObject = nullptr;
+    auto itType = _typeIndexes.constFind(mObjectType);
+    if (itType != _typeIndexes.cend())
+    {
+        const QMultiHash<QString, MObject*> &typeIndex = itType.value();
+        for (auto it = typeIndex.constFind(name), itEnd = typeIndex.constEnd(); it != itEnd && it.key() == name; ++it)
+        {
+            if (!mObject || it.value()->getId() < mObject->getId())
+                mObject = it.value();
+        }
+    }
+    return mObject;
+}
+
+void NameIndex::propertyValueChanged(MObject *mObject, Property *property)
+{
+    Q_UNUSED(property);
+    auto itName = _indexedNames.find(mObject);
+    if (itName != _indexedNames.end())
+    {
+        QString newName = mObject->getName();
+        if (newName != itName.value())
+        {
+            QMultiHash<QString, MObject*> &typeIndex = _typeIndexes[mObject->getModelObjectType()];
+            typeIndex.remove(itName.value(), mObject);
+            typeIndex.insert(newName, mObject);
+            itName.value() = newName;
+        }
+    }
+}
@@ -0,0 +1,72 @@
+//========================================================================
+//
+// Copyright (C) 2018 Matthieu Bruel <Matthieu.Bruel@gmail.com>
+//
+// This file is a part of miniEMF++ : https://github.com/mbruel/miniEMF
+//
+// miniEMF++ is free software; you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as
+// published by the Free Software Foundation; version 3.0 of the License.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+// You should have received a copy of the GNU Lesser General Public
+// License along with this program; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301,
+// USA.
+//
+//========================================================================
+
+#ifndef NAMEINDEX_H
+#define NAMEINDEX_H
+
+#include "aliases.h"
+#include "PropertyObserver.h"
+#include <QHash>
+#include <QMultiHash>
+
+class MObjectType;
+
+/**
+ * @brief NameIndex indexes by name the MObjects of some instanciable types of a Model
+ * (cf Model::enableNameIndex)
+ *
+ * It observes MObject::PROPERTY_NAME so that it stays up to date when the MObjects are renamed.
+ */
+class NameIndex : public PropertyObserver
+{
+public:
+    NameIndex();
+    ~NameIndex() override;
+
+    NameIndex(const NameIndex &other) = delete;
+    NameIndex(NameIndex &&other) = delete;
+
+    NameIndex & operator=(const NameIndex &other) = delete;
+    NameIndex & operator=(NameIndex &&other) = delete;
+
+    void addType(MObjectType *mObjectType, const QList<MObject*> &mObjects);
+    void removeType(MObjectType *mObjectType);
+    inline bool hasType(MObjectType *mObjectType) const;
+    inline bool isEmpty() const;
+
+    void insert(MObject *mObject); //!< only if its type is indexed
+    void remove(MObject *mObject);
+    void clear(); //!< remove all the MObjects (the types stay indexed)
+
+    //! the one with the smallest id if several MObjects of the type have the name
+    MObject *find(MObjectType *mObjectType, const QString &name) const;
+
+    void propertyValueChanged(MObject *mObject, Property *property) override;
+
+private:
+    QHash<MObjectType*, QMultiHash<QString, MObject*> > _typeIndexes;
+    QHash<MObject*, QString>                            _indexedNames; //!< name under which each MObject is indexed
+};
+
+bool NameIndex::hasType(MObjectType *mObjectType) const { return _typeIndexes.contains(mObjectType); }
+bool NameIndex::isEmpty() const { return _typeIndexes.isEmpty(); }
+
+#endif // NAMEINDEX_H
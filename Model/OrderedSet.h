@@ -0,0 +1,211 @@
+//========================================================================
+//
+// Copyright (C) 2018 Matthieu Bruel <Matthieu.Bruel@gmail.com>
+//
+// This file is a part of miniEMF++ : https://github.com/mbruel/miniEMF
+//
+// miniEMF++ is free software; you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as
+// published by the Free Software Foundation; version 3.0 of the License.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+// You should have received a copy of the GNU Lesser General Public
+// License along with this program; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301,
+// USA.
+//
+//========================================================================
+
+#ifndef ORDEREDSET_H
+#define ORDEREDSET_H
+
+#include <QVector>
+#include <QHash>
+#include <QList>
+
+/**
+ * @brief OrderedSet keeps its values in insertion order with a constant time contains, insert and remove
+ * (used for the ordered links: OrderedLinkToManyProperty)
+ *
+ * The removed values leave a hole (T()) in the vector that is compacted when there are too many.
+ * T() can't be inserted (nullptr for the MObject*).
+ */
+template <typename T> class OrderedSet
+{
+public:
+    class const_iterator
+    {
+    public:
+        inline const_iterator(const QVector<T> *values, int pos);
+
+        inline const T &operator*() const;
+        inline const_iterator &operator++();
+        inline bool operator==(const const_iterator &other) const;
+        inline bool operator!=(const const_iterator &other) const;
+
+    private:
+        inline void _skipHoles();
+
+        const QVector<T> *_values;
+        int               _pos;
+    };
+
+    OrderedSet() = default;
+    explicit OrderedSet(const QList<T> &values);
+
+    inline int  size() const;
+    inline bool isEmpty() const;
+    inline bool contains(const T &value) const;
+
+    bool insert(const T &value); //!< append the value if it is not already in
+    inline void append(const T &value);
+    bool remove(const T &value);
+    inline void clear();
+    inline void swap(OrderedSet &other);
+
+    QList<T> toList() const;
+
+    bool operator==(const OrderedSet &other) const; //!< same values in the same order
+    inline bool operator!=(const OrderedSet &other) const;
+
+    inline const_iterator begin() const;
+    inline const_iterator end() const;
+    inline const_iterator cbegin() const;
+    inline const_iterator cend() const;
+
+private:
+    void _compact();
+
+    QVector<T>    _values; //!< in insertion order (with holes)
+    QHash<T, int> _index;  //!< position of each value in _values
+};
+
+
+///////////////////////////////////////////////////////
+/// Template functions definition (generic)
+///
+template <typename T>
+OrderedSet<T>::OrderedSet(const QList<T> &values):
+    _values(), _index()
+{
+    _values.reserve(values.size());
+    _index.reserve(values.size());
+    for (const T &value : values)
+        insert(value);
+}
+
+template <typename T> int  OrderedSet<T>::size() const { return _index.size(); }
+template <typename T> bool OrderedSet<T>::isEmpty() const { return _index.isEmpty(); }
+template <typename T> bool OrderedSet<T>::contains(const T &value) const { return _index.contains(value); }
+template <typename T> void OrderedSet<T>::append(const T &value) { insert(value); }
+template <typename T> void OrderedSet<T>::clear() { _values.clear(); _index.clear(); }
+template <typename T> bool OrderedSet<T>::operator!=(const OrderedSet &other) const { return !(*this == other); }
+
+template <typename T>
+void OrderedSet<T>::swap(OrderedSet &other)
+{
+    _values.swap(other._values);
+    _index.swap(other._index);
+}
+
+template <typename T>
+bool OrderedSet<T>::insert(const T &value)
+{
+    if (value == T() || _index.contains(value))
+        return false;
+
+    _index.insert(value, _values.size());
+    _values.append(value);
+    return true;
+}
+
+template <typename T>
+bool OrderedSet<T>::remove(const T &value)
+{
+    auto it = _index.find(value);
+    if (it == _index.end())
+        return false;
+
+    _values[it.value()] = T();
+    _index.erase(it);
+    if (_values.size() > 2 * _index.size() + 16)
+        _compact();
+    return true;
+}
+
+template <typename T>
+QList<T> OrderedSet<T>::toList() const
+{
+    QList<T> values;
+    values.reserve(_index.size());
+    for (const T &value : *this)
+        values.append(value);
+    return values;
+}
+
+template <typename T>
+bool OrderedSet<T>::operator==(const OrderedSet &other) const
+{
+    if (_index.size() != other._index.size())
+        return false;
+
+    for (auto it = cbegin(), itEnd = cend(), itOther = other.cbegin() ; it != itEnd ; ++it, ++itOther)
+    {
+        if (*it != *itOther)
+            return false;
+    }
+    return true;
+}
+
+template <typename T> typename OrderedSet<T>::const_iterator OrderedSet<T>::begin() const { return const_iterator(&_values, 0); }
+template <typename T> typename OrderedSet<T>::const_iterator OrderedSet<T>::end() const { return const_iterator(&_values, _values.size()); }
+template <typename T> typename OrderedSet<T>::const_iterator OrderedSet<T>::cbegin() const { return begin(); }
+template <typename T> typename OrderedSet<T>::const_iterator OrderedSet<T>::cend() const { return end(); }
+
+template <typename T>
+void OrderedSet<T>::_compact()
+{
+    int pos = 0;
+    for (int i = 0 ; i < _values.size() ; ++i)
+    {
+        const T &value = _values.at(i);
+        if (value != T())
+        {
+            _values[pos] = value;
+            _index[value] = pos++;
+        }
+    }
+    _values.resize(pos);
+}
+
+template <typename T>
+OrderedSet<T>::const_iterator::const_iterator(const QVector<T> *values, int pos):
+    _values(values), _pos(pos)
+{
+    _skipHoles();
+}
+
+template <typename T> const T &OrderedSet<T>::const_iterator::operator*() const { return _values->at(_pos); }
+
+template <typename T>
+typename OrderedSet<T>::const_iterator &OrderedSet<T>::const_iterator::operator++()
+{
+    ++_pos;
+    _skipHoles();
+    return *this;
+}
+
+template <typename T> bool OrderedSet<T>::const_iterator::operator==(const const_iterator &other) const { return _pos == other._pos; }
+template <typename T> bool OrderedSet<T>::const_iterator::operator!=(const const_iterator &other) const { return _pos != other._pos; }
+
+template <typename T>
+void OrderedSet<T>::const_iterator::_skipHoles()
+{
+    while (_pos < _values->size() && _values->at(_pos) == T())
+        ++_pos;
+}
+
+#endif // ORDEREDSET_H
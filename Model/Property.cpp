@@ -29,10 +29,29 @@ const float  Property::FLT_INFINITE_NEG = -std::numeric_limits<float>::max();
 const double Property::DBL_INFINITE_POS = std::numeric_limits<double>::max();
 const double Property::DBL_INFINITE_NEG = -std::numeric_limits<double>::max();
 
+namespace
+{
+//! call function(const ElemId &) for each id of a xmi list ("id1 id2 ...") without allocating the tokens
+template<typename Function> void forEachXMIId(const QString &ids, Function function)
+{
+    const QChar *str = ids.constData(), *strEnd = str + ids.size();
+    while (str != strEnd)
+    {
+        while (str != strEnd && str->isSpace())
+            ++str;
+        const QChar *id = str;
+        while (str != strEnd && !str->isSpace())
+            ++str;
+        if (str != id)
+            function(ElemId::fromString(id, static_cast<int>(str - id)));
+    }
+}
+}
 
 #include <QCoreApplication>
-Property::Property(const QString &name, const char *label, bool isSerializable):
-    _name(name), _label(label), _unit(""), _serializable(isSerializable), _propertiesUsingAsKey()
+Property::Property(const QString &name, const char *label, bool isSerializable, bool isUnboxed):
+    _name(name), _label(label), _unit(""), _serializable(isSerializable), _isUnboxed(isUnboxed),
+    _propertiesUsingAsKey(), _slot(-1), _observers()
 {}
 
 QString Property::getLabel() const { return QCoreApplication::translate("Property", _label);} //QObject::tr(_label); }
@@ -47,7 +66,7 @@ QVariant Property::convertIntoUpdatableValue(QVariant value) { return value; }
 MObjectList Property::getMapValuesInInsertionOrder(const MObjectMap &map)
 {
     MObjectList values;
-    for (const QVariant & key : map.uniqueKeys())
+    for (const MapKey & key : map.uniqueKeys())
     {
         MObjectList mObjects = map.values(key);
         auto it = mObjects.cend(), itStart = mObjects.cbegin();
@@ -223,6 +242,35 @@ void LinkProperty::deserializeFromXmiAttribute(MObject *mObject, const QString &
     // No action : the deserialization is managed directly by ElementDao::deserializeModelObject(QDomNode node)
 }
 
+void LinkProperty::setValueFromXMIStringIdList(MObject *mObject, const QString &ids, Model *model)
+{
+    MObjectList linkedModelObjects;
+    resolveXMIStringIdList(mObject, ids, model, linkedModelObjects);
+    setValueFromXMIResolvedList(mObject, linkedModelObjects);
+}
+
+void LinkProperty::resolveXMIStringIdList(MObject *mObject, const QString &ids, Model *model, MObjectList &linkedModelObjects)
+{
+    MObjectType *linkedEltType = mObject->getLinkedModelObjectType(this);
+    forEachXMIId(ids, [model, linkedEltType, &linkedModelObjects](const ElemId &id){
+        MObject *linkedModelObject = model->getModelObjectById(linkedEltType, id);
+        if (linkedModelObject)
+            linkedModelObjects.append(linkedModelObject);
+    });
+}
+
+void LinkProperty::setValueFromXMIResolvedList(MObject *mObject, MObjectList &linkedModelObjects)
+{
+    if (!linkedModelObjects.isEmpty())
+        updateValue(mObject, linkedModelObjects);
+}
+
+void LinkProperty::addLinks(MObject *const mObject, const MObjectList &mObjectsToAdd)
+{
+    for (MObject *mObjectToAdd : mObjectsToAdd)
+        addLink(mObject, mObjectToAdd);
+}
+
 void LinkProperty::validateModelObject(MObject *mObject, QStringList &ecoreErrors)
 {
     if (_isMandatory && getLinkedModelObjects(mObject).isEmpty())
@@ -230,6 +278,45 @@ void LinkProperty::validateModelObject(MObject *mObject, QStringList &ecoreError
                            mObject->getName()).arg(getLabel());
 }
 
+void LinkProperty::_updateReverseLinks(MObject *mObject, const MObjectMultiMap &oldValueMap, const MObjectMultiMap &newValueMap)
+{
+    // both maps are sorted by key: we walk them together and only compare the values sharing a key
+    auto itOld = oldValueMap.cbegin(), itOldEnd = oldValueMap.cend();
+    auto itNew = newValueMap.cbegin(), itNewEnd = newValueMap.cend();
+    MObjectList oldValues, newValues;
+    while (itOld != itOldEnd || itNew != itNewEnd)
+    {
+        bool takeOld = itOld != itOldEnd && (itNew == itNewEnd || !(itNew.key() < itOld.key())),
+             takeNew = itNew != itNewEnd && (itOld == itOldEnd || !(itOld.key() < itNew.key()));
+
+        const MapKey key = takeOld ? itOld.key() : itNew.key();
+        oldValues.clear();
+        newValues.clear();
+        if (takeOld)
+        {
+            for ( ; itOld != itOldEnd && !(key < itOld.key()) ; ++itOld)
+                oldValues.append(itOld.value());
+        }
+        if (takeNew)
+        {
+            for ( ; itNew != itNewEnd && !(key < itNew.key()) ; ++itNew)
+                newValues.append(itNew.value());
+        }
+
+        // few values per key: pairwise
+        for (MObject *linkedModelObject : newValues)
+        {
+            if (!oldValues.contains(linkedModelObject))
+                _reverseLinkProperty->addLink(linkedModelObject, mObject);
+        }
+        for (MObject *linkedModelObject : oldValues)
+        {
+            if (!newValues.contains(linkedModelObject))
+                _reverseLinkProperty->removeLink(linkedModelObject, mObject);
+        }
+    }
+}
+
 
 // ############################
 // #### LinkToOne PROPERTY ####
@@ -251,20 +338,46 @@ void LinkToOneProperty::setValues(MObject *mObject, const MObjectList &values)
     setValue(mObject, value);
 }
 
-void LinkToOneProperty::setValueFromXMIStringIdList(MObject *mObject, const QString &ids, Model *model)
+void LinkToOneProperty::resolveXMIStringIdList(MObject *mObject, const QString &ids, Model *model, MObjectList &linkedModelObjects)
 {
-    QSet<MObjectType *> allPossibleTypes = _linkedModelObjectType->getSuperInstanciableModelObjectTypes();
-    allPossibleTypes.insert(_linkedModelObjectType);
-    QString objectId = ids.trimmed();
-    for (MObjectType *linkedType : allPossibleTypes)
+    Q_UNUSED(mObject);
+    ElemId objectId;
+    forEachXMIId(ids, [&objectId](const ElemId &id){
+        if (objectId.isNull())
+            objectId = id;
+    });
+
+    // the super types are only looked for if the id is not one of the linked type
+    MObject *linkedElt = model->getModelObjectById(_linkedModelObjectType, objectId);
+    if (!linkedElt)
     {
-        MObject *linkedElt = model->getModelObjectById(linkedType, objectId);
-        if (linkedElt)
+        for (MObjectType *linkedType : _linkedModelObjectType->getSuperInstanciableModelObjectTypes())
         {
-            updateValue(mObject, linkedElt->toVariant());
-            break;
+            linkedElt = model->getModelObjectById(linkedType, objectId);
+            if (linkedElt)
+                break;
         }
     }
+    if (linkedElt)
+        linkedModelObjects.append(linkedElt);
+}
+
+bool LinkToOneProperty::initValues(MObject *mObject, MObjectList &values)
+{
+    if (getValue(mObject))
+        return false;
+
+    while (values.size() > 1)
+        values.removeLast(); // as setValues, only the first one is linked
+    setValues(mObject, values);
+    return true;
+}
+
+void LinkToOneProperty::addLinks(MObject *const mObject, const MObjectList &mObjectsToAdd)
+{
+    // as adding them one by one: the last one wins (unless it is already one of them)
+    if (!mObjectsToAdd.isEmpty() && !mObjectsToAdd.contains(getValue(mObject)))
+        setValue(mObject, mObjectsToAdd.last());
 }
 
 void LinkToOneProperty::setValueFromLinkedObjectName(MObject *mObject, MObjectType *linkedObjType, const QString &linkedObjName, Model *model)
@@ -501,6 +614,12 @@ MapLinkProperty::MapLinkProperty(MObjectType * const eltType,
 
 void MapLinkProperty::setKey(Property *key)
 {
+    if (!key->canKeyMaps())
+    {
+        qCritical() << "[MapLinkProperty::setKey] ERROR: " << key->getName()
+                    << " can't key the map " << _name << " (only the single-valued attributes can)";
+        return;
+    }
     _keyProperty = key;
     key->_propertiesUsingAsKey.insert(this);
 }
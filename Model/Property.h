@@ -31,6 +31,10 @@
 
 #include <Utils/XmiWriter.h>
 
+#include "PropertyRawValue.h"
+#include "PropertyObserver.h"
+#include "OrderedSet.h"
+#include "SmallSet.h"
 #include "MObject.h"
 #include "Model.h"
 
@@ -42,6 +46,8 @@
 class Property
 {
     friend class MapLinkProperty;
+    friend class PropertyFactory; // to assign the slots
+    friend class PropertyLayout;  // to assign the slot of a Property added by hand in a class map
 
 public:
     virtual ~Property() = default;
@@ -59,6 +65,17 @@ public:
     virtual bool isEcoreContainer()    const { return false; }
 
     virtual QVariant createNewInitValue() = 0;
+    virtual void deleteValue(MObject *mObject) { Q_UNUSED(mObject); } //!< free what createNewInitValue allocated (cf ~MObject)
+
+    // unboxed properties only (cf isUnboxedAttribute)
+    virtual PropertyRawValue createNewInitRawValue() const { return PropertyRawValue(); }
+    virtual QVariant toVariant(const PropertyRawValue &rawValue) const { Q_UNUSED(rawValue); return QVariant(); }
+    virtual PropertyRawValue toRawValue(const QVariant &value) const { Q_UNUSED(value); return PropertyRawValue(); }
+    virtual AttributeColumn *createAttributeColumn() const { return nullptr; }
+
+    // single-valued attributes only (cf MapLinkProperty::setKey)
+    virtual bool canKeyMaps() const { return false; }
+    virtual MapKey getMapKey(const MObject *mObject) { Q_UNUSED(mObject); return MapKey(); } //!< key of mObject in the maps keyed by the Property
 
     virtual void serializeAsXmiAttribute(XmiWriter *xmiWriter, MObject *mObject) = 0;
     virtual void deserializeFromXmiAttribute(MObject *const mObject, const QString &xmiValue) = 0;
@@ -84,19 +101,91 @@ public:
     inline bool hasPropertiesUsingAsKey() const;
     inline const QSet<MapLinkProperty*> &getPropertiesUsingAsKey() const;
 
+    inline int getSlot() const; //!< index of the value in the MObject storage (-1 until PropertyFactory::initProperties)
+    inline bool isUnboxed() const; //!< stored as a PropertyRawValue in the MObjects (not in a QVariant)
+    virtual bool isSmallSetLink() const { return false; } //!< stored inline as a MObjectSmallSet in the MObjects (not in a QVariant)
+
+    // observers notified after each change of the value of the Property in a MObject
+    inline void addObserver(PropertyObserver *observer);
+    inline void removeObserver(PropertyObserver *observer);
+    inline bool hasObservers() const;
+    inline void notifyValueChanged(MObject *mObject);
+
 protected:
-    Property(const QString &name, const char *label, bool isSerializable = true);
+    Property(const QString &name, const char *label, bool isSerializable = true, bool isUnboxed = false);
 
 protected:
     const QString          _name;
     const char            *_label;
     const char            *_unit;
     const bool             _serializable;
+    const bool             _isUnboxed;
     QSet<MapLinkProperty*> _propertiesUsingAsKey;
+    int                    _slot; //!< same in all the classes using the Property (cf PropertyFactory::_assignPropertySlots)
+    QList<PropertyObserver*> _observers;
 };
 
 bool Property::hasPropertiesUsingAsKey() const {return _propertiesUsingAsKey.size() > 0;}
 const QSet<MapLinkProperty*> &Property::getPropertiesUsingAsKey() const {return _propertiesUsingAsKey;}
+int Property::getSlot() const { return _slot; }
+bool Property::isUnboxed() const { return _isUnboxed; }
+
+void Property::addObserver(PropertyObserver *observer)
+{
+    if (!_observers.contains(observer))
+        _observers.append(observer);
+}
+void Property::removeObserver(PropertyObserver *observer) { _observers.removeAll(observer); }
+bool Property::hasObservers() const { return !_observers.isEmpty(); }
+void Property::notifyValueChanged(MObject *mObject)
+{
+    if (!mObject->_nbObservingModels)
+        return; // none of its Models has an index or a validation cache (or it is not in a Model yet)
+    for (PropertyObserver *observer : _observers)
+        observer->propertyValueChanged(mObject, this);
+}
+
+// the MObject must have the property: its slot could hold the value of another property of the class
+const QVariant &MObject::_value(const Property *property) const
+{
+    Q_ASSERT(!property->isUnboxed() && !property->isSmallSetLink() && _propertyLayout->hasProperty(property));
+    return _propertyValues.at(property->getSlot());
+}
+QVariant &MObject::_value(const Property *property)
+{
+    Q_ASSERT(!property->isUnboxed() && !property->isSmallSetLink() && _propertyLayout->hasProperty(property));
+    return _propertyValues[property->getSlot()];
+}
+const PropertyRawValue &MObject::_rawValue(const Property *property) const
+{
+    Q_ASSERT(property->isUnboxed() && _propertyLayout->hasProperty(property));
+    return _rawPropertyValues.at(property->getSlot());
+}
+PropertyRawValue &MObject::_rawValue(const Property *property)
+{
+    Q_ASSERT(property->isUnboxed() && _propertyLayout->hasProperty(property));
+    return _rawPropertyValues[property->getSlot()];
+}
+const MObjectSmallSet &MObject::_smallSetValue(const Property *property) const
+{
+    Q_ASSERT(property->isSmallSetLink() && _propertyLayout->hasProperty(property));
+    return _smallSetValues.at(property->getSlot());
+}
+
+// the LinkToManyProperty values are inline in the MObject: they exist even when the link is empty
+template<> MObjectSmallSet *MObject::getLinkPropertyValue<MObjectSmallSet>(Property *property) const
+{
+    _loadLazyLinks();
+    return const_cast<MObjectSmallSet*>(&_smallSetValue(property)); // no detach: _smallSetValues is never shared
+}
+template<> MObjectSmallSet *MObject::getOrCreateLinkPropertyValue<MObjectSmallSet>(Property *property)
+{
+    return getLinkPropertyValue<MObjectSmallSet>(property);
+}
+template<> void MObject::deleteLinkPropertyValue<MObjectSmallSet>(Property *property)
+{
+    getLinkPropertyValue<MObjectSmallSet>(property)->clear();
+}
 
 
 template<typename TypeAttribute> class AttributeProperty : public Property{
@@ -115,6 +204,14 @@ public:
     // Mandatory function to be instanciable
     QVariant createNewInitValue() override { return _defaultValue; }
 
+    PropertyRawValue createNewInitRawValue() const override;
+    QVariant toVariant(const PropertyRawValue &rawValue) const override;
+    PropertyRawValue toRawValue(const QVariant &value) const override;
+    AttributeColumn *createAttributeColumn() const override;
+
+    bool canKeyMaps() const override { return true; }
+    MapKey getMapKey(const MObject *mObject) override;
+
     virtual void serializeAsXmiAttribute(XmiWriter *xmiWriter, MObject *mObject) override;
     virtual void deserializeFromXmiAttribute(MObject *const mObject, const QString &xmiValue) override;
 
@@ -127,6 +224,14 @@ public:
 #endif
 
 private:
+    // the raw values and the columns only exist for the unboxed attributes
+    PropertyRawValue _toRawValue(const TypeAttribute &value, std::true_type) const;
+    PropertyRawValue _toRawValue(const TypeAttribute &, std::false_type) const { return PropertyRawValue(); }
+    QVariant _toVariant(const PropertyRawValue &rawValue, std::true_type) const { return QVariant::fromValue(rawValue.get<TypeAttribute>()); }
+    QVariant _toVariant(const PropertyRawValue &, std::false_type) const { return QVariant(); }
+    AttributeColumn *_createAttributeColumn(std::true_type) const;
+    AttributeColumn *_createAttributeColumn(std::false_type) const { return nullptr; }
+
     TypeAttribute _defaultValue;
 };
 
@@ -252,7 +357,17 @@ public:
     virtual void serializeAsXmiAttribute(XmiWriter *xmiWriter, MObject *mObject) override;
     void deserializeFromXmiAttribute(MObject *mObject, const QString &xmiValue) override;
 
-    virtual void setValueFromXMIStringIdList(MObject *mObject, const QString &ids, Model *model) = 0;
+    // setValueFromXMIStringIdList is done in 2 steps so the resolution (that only reads the Model) can be done in parallel
+    virtual void setValueFromXMIStringIdList(MObject *mObject, const QString &ids, Model *model);
+    virtual void resolveXMIStringIdList(MObject *mObject, const QString &ids, Model *model, MObjectList &linkedModelObjects);
+    virtual void setValueFromXMIResolvedList(MObject *mObject, MObjectList &linkedModelObjects);
+
+    // bulk setters used by XMIService::_linkModelObjects: the reverse links are done afterward, grouped by linked MObject
+    //! set the values without updating the reverse links, only if mObject has no link yet (false otherwise)
+    //! values is updated with the MObjects that are actually linked
+    virtual bool initValues(MObject *mObject, MObjectList &values) = 0;
+    //! same as addLink for each of them (those already linked are skipped)
+    virtual void addLinks(MObject *const mObject, const MObjectList &mObjectsToAdd);
     virtual void setValueFromLinkedObjectName(MObject *mObject, MObjectType *linkedObjType, const QString &linkedObjName, Model *model) = 0;
 
      void validateModelObject(MObject *mObject, QStringList &ecoreErrors);
@@ -265,6 +380,9 @@ public:
 protected:
     LinkProperty(MObjectType *const eltType, MObjectType *const linkedEltType, const QString &name, const char *label, bool isMandatory, bool isSerializable = true);
 
+    //! add the reverse links of the (key, value) only in newValueMap and remove the ones only in oldValueMap (single merge pass)
+    void _updateReverseLinks(MObject *mObject, const MObjectMultiMap &oldValueMap, const MObjectMultiMap &newValueMap);
+
 protected:
     MObjectType  *_mObjectType;       // MObjectType to which this LinkProperty belongs
     MObjectType  *_linkedModelObjectType; // MObjectType linked through this LinkProperty
@@ -300,9 +418,12 @@ public:
     void setValue(MObject *const mObject, MObject *const value);
     void setValues(MObject *mObject, const MObjectList &values) override;
 
-    void setValueFromXMIStringIdList(MObject *mObject, const QString &ids, Model *model) override;
+    void resolveXMIStringIdList(MObject *mObject, const QString &ids, Model *model, MObjectList &linkedModelObjects) override;
     void setValueFromLinkedObjectName(MObject *mObject, MObjectType *linkedObjType, const QString &linkedObjName, Model *model)  override;
 
+    bool initValues(MObject *mObject, MObjectList &values) override;
+    void addLinks(MObject *const mObject, const MObjectList &mObjectsToAdd) override;
+
 #ifdef __USE_HMI__
     virtual QWidget *getEditor(MObject *const mObj, QWidget *parent = nullptr) override;
     virtual QVariant getEditorUpdatedVariant(MObject *const mObj, QWidget *editor) override;
@@ -326,30 +447,35 @@ public:
     virtual bool isOrdered()            const override { return true; }
     virtual bool isMapProperty()        const override { return false; }
     virtual bool isALinkToOneProperty() const override { return false; }
+    bool isSmallSetLink() const override { return std::is_same<Container<Args..., MObject*>, MObjectSmallSet>::value; }
 
     GenericLinkToManyProperty(MObjectType *const eltType, MObjectType *const linkedEltType, const QString &name, const char *label, bool isMandatory, bool isSerializable = true):
         LinkProperty(eltType, linkedEltType, name, label, isMandatory, isSerializable) {}
     virtual ~GenericLinkToManyProperty() = default;
 
     QVariant createNewInitValue() override;
+    void deleteValue(MObject *mObject) override;
 
     virtual void addLink(MObject *const mObject, MObject *const mObjectToAdd) override;
     virtual void removeLink(MObject *const mObject, MObject *const mObjectToRemove) override;
     virtual void updateValue(MObject *const mObject, QVariant value) override;
     virtual MObjectList getLinkedModelObjects(MObject *const mObject, bool ordered = true) override;
 
-    Container<Args..., MObject*> *getValues(const MObject *const mObject) ;
+    Container<Args..., MObject*> *getValues(MObject *const mObject); //!< allocate the container if the link is still empty
+    const Container<Args..., MObject*> &constValues(const MObject *const mObject); //!< read only, no allocation
     void setValues(MObject *mObject, Container<Args..., MObject*> *values);
     void setValues(MObject *mObject, const MObjectList &values) override;
 
     // Handy setter from a QSet
     void updateValue(MObject *const mObject, MObjectList &values) override;
 
+    bool initValues(MObject *mObject, MObjectList &values) override;
+    void addLinks(MObject *const mObject, const MObjectList &mObjectsToAdd) override;
+
     virtual MObjectMap *getLinkedModelObjectsMap(MObject *const mObject) override {Q_UNUSED(mObject);return nullptr;}
     virtual void setValuesFromMap(MObject *mObject, MObjectMap *values) override {Q_UNUSED(mObject);Q_UNUSED(values);}
 
     virtual void serializeAsXmiAttribute(XmiWriter *xmiWriter, MObject *mObject) override;
-    virtual void setValueFromXMIStringIdList(MObject *mObject, const QString &ids, Model *model) override;
     void setValueFromLinkedObjectName(MObject *mObject, MObjectType *linkedObjType, const QString &linkedObjName, Model *model)  override;
 };
 
@@ -417,27 +543,59 @@ public:
 template <template <typename...> class Container, typename... Args>
     QVariant GenericLinkToManyProperty<Container, Args...>::createNewInitValue()
 {
-    return QVariant::fromValue(static_cast<void*>(new Container<Args..., MObject*>()));
+    return QVariant::fromValue(static_cast<void*>(nullptr)); // empty links are allocated on their first write
+}
+template <template <typename...> class Container, typename... Args>
+    void GenericLinkToManyProperty<Container, Args...>::deleteValue(MObject *mObject)
+{
+    mObject->deleteLinkPropertyValue<Container<Args..., MObject*>>(this);
 }
 template <template <typename...> class Container, typename... Args>
-    Container<Args..., MObject*> * GenericLinkToManyProperty<Container, Args...>::getValues(const MObject * const mObject)
+    Container<Args..., MObject*> * GenericLinkToManyProperty<Container, Args...>::getValues(MObject * const mObject)
 {
-    return mObject->getLinkPropertyValue<Container<Args..., MObject*>>(this);
+    return mObject->getOrCreateLinkPropertyValue<Container<Args..., MObject*>>(this);
+}
+template <template <typename...> class Container, typename... Args>
+    const Container<Args..., MObject*> & GenericLinkToManyProperty<Container, Args...>::constValues(const MObject * const mObject)
+{
+    static const Container<Args..., MObject*> sEmptyValues;
+    const Container<Args..., MObject*> *values = mObject->getLinkPropertyValue<Container<Args..., MObject*>>(this);
+    return values ? *values : sEmptyValues;
 }
 template <template <typename...> class Container, typename... Args>
     void GenericLinkToManyProperty<Container, Args...>::setValues(MObject *mObject, Container<Args..., MObject*> *values)
 {
     mObject->setLinkToManyPropertyValue<Container<Args..., MObject*>>(this, values);
+    notifyValueChanged(mObject);
 }
 template <template <typename...> class Container, typename... Args>
     void GenericLinkToManyProperty<Container, Args...>::addLink(MObject *const mObject, MObject *const mObjectToAdd)
 {
     mObject->addALinkToMany<Container, Args...>(this, mObjectToAdd);
+    notifyValueChanged(mObject);
 }
 template <template <typename...> class Container, typename... Args>
     void GenericLinkToManyProperty<Container, Args...>::removeLink(MObject *const mObject, MObject *const mObjectToRemove)
 {
     mObject->removeALinkFromMany<Container, Args...>(this, mObjectToRemove);
+    notifyValueChanged(mObject);
+}
+template <template <typename...> class Container, typename... Args>
+    bool GenericLinkToManyProperty<Container, Args...>::initValues(MObject *mObject, MObjectList &values)
+{
+    if (!constValues(mObject).isEmpty())
+        return false;
+
+    setValues(mObject, values);
+    return true;
+}
+template <template <typename...> class Container, typename... Args>
+    void GenericLinkToManyProperty<Container, Args...>::addLinks(MObject *const mObject, const MObjectList &mObjectsToAdd)
+{
+    Container<Args..., MObject*> *values = getValues(mObject);
+    for (MObject *mObjectToAdd : mObjectsToAdd)
+        values->insert(mObjectToAdd); // no duplicate in a set
+    notifyValueChanged(mObject);
 }
 template <template <typename...> class Container, typename... Args>
     void GenericLinkToManyProperty<Container, Args...>::serializeAsXmiAttribute(XmiWriter *xmiWriter, MObject *mObject)
@@ -459,27 +617,27 @@ template <template <typename...> class Container, typename... Args>
 // Template specializations for GenericLinkToManyProperty
 //////////////////////////////////////////////////////////
 
-// Template specializations of getLinkedModelObjects for QSet, QList, QMap and QMultiMap
+// Template specializations of getLinkedModelObjects for SmallSet, OrderedSet, QMap and QMultiMap
 template <> inline MObjectList LinkToManyProperty::getLinkedModelObjects(MObject *const mObject, bool ordered)
 {
     if (ordered)
     {
-        MObjectList list = getValues(mObject)->toList();
+        MObjectList list = constValues(mObject).toList();
         std::sort(list.begin(), list.end(), &MObject::elementIdLessThan);
         return list;
     }
     else
-        return getValues(mObject)->toList();
+        return constValues(mObject).toList();
 }
 template <> inline MObjectList OrderedLinkToManyProperty::getLinkedModelObjects(MObject *const mObject, bool ordered)
 {
     Q_UNUSED(ordered)
-    return *(getValues(mObject));
+    return constValues(mObject).toList();
 }
 template <> inline MObjectList MultiMapLinkPropertyInterface::getLinkedModelObjects(MObject *const mObject, bool ordered)
 {
     Q_UNUSED(ordered)
-    return getValues(mObject)->values();
+    return constValues(mObject).values();
 }
 template <> inline MObjectMap *MultiMapLinkPropertyInterface::getLinkedModelObjectsMap(MObject *const mObject)
 {
@@ -491,16 +649,16 @@ template <> inline  void MultiMapLinkPropertyInterface::setValuesFromMap(MObject
     setValues(mObject, &multiMap);
 }
 
-// Template specializations of setValue with MObjectList for QSet, QList, QMap and QMultiMap
+// Template specializations of setValue with MObjectList for SmallSet, OrderedSet, QMap and QMultiMap
 template <> inline void LinkToManyProperty::setValues(MObject *mObject, const MObjectList &values)
 {
-    MObjectSet mObjSet = values.toSet();
+    MObjectSmallSet mObjSet(values);
     setValues(mObject, &mObjSet);
 }
 template <> inline void OrderedLinkToManyProperty::setValues(MObject *mObject, const MObjectList &values)
 {
-    MObjectList mObjList = values;
-    setValues(mObject, &mObjList);
+    MObjectOrderedSet mObjOrderedSet(values);
+    setValues(mObject, &mObjOrderedSet);
 }
 template <> inline void MultiMapLinkPropertyInterface::setValues(MObject *mObject, const MObjectList &values)
 {
@@ -511,26 +669,26 @@ template <> inline void MultiMapLinkPropertyInterface::setValues(MObject *mObjec
 }
 
 
-// Template specializations of updateValue for QSet, QList, QMap and QMultiMap
+// Template specializations of updateValue for SmallSet, OrderedSet, QMap and QMultiMap
 template <> inline void LinkToManyProperty::updateValue(MObject *const mObject, QVariant value)
 {
     if (!value.canConvert<void* >())
         return;
 
-    MObjectSet *newValueSet = static_cast<MObjectSet*>(value.value<void*>()),
-            *oldValueSet = mObject->getLinkPropertyValue<MObjectSet>(this);
-    if (*newValueSet == *oldValueSet)
+    MObjectSmallSet *newValueSet = static_cast<MObjectSmallSet*>(value.value<void*>());
+    const MObjectSmallSet &oldValueSet = constValues(mObject);
+    if (*newValueSet == oldValueSet)
         return;
 
     if (_reverseLinkProperty)
     {
         for (MObject *linkedModelObject : *newValueSet)
         {
-            if (!oldValueSet->contains(linkedModelObject))
+            if (!oldValueSet.contains(linkedModelObject))
                 _reverseLinkProperty->addLink(linkedModelObject, mObject);
         }
 
-        for (MObject *linkedModelObject : *oldValueSet)
+        for (MObject *linkedModelObject : oldValueSet)
         {
             if(!newValueSet->contains(linkedModelObject))
                 _reverseLinkProperty->removeLink(linkedModelObject, mObject);
@@ -545,27 +703,27 @@ template <> inline void OrderedLinkToManyProperty::updateValue(MObject *const mO
     if (!value.canConvert<void* >())
         return;
 
-    MObjectList *newValueList = static_cast<MObjectList*>(value.value<void*>()),
-            *oldValueList = mObject->getLinkPropertyValue<MObjectList>(this);
-    if (*newValueList == *oldValueList)
+    MObjectOrderedSet *newValueSet = static_cast<MObjectOrderedSet*>(value.value<void*>());
+    const MObjectOrderedSet &oldValueSet = constValues(mObject);
+    if (*newValueSet == oldValueSet)
         return;
 
     if (_reverseLinkProperty)
     {
-        for (MObject *linkedModelObject : *newValueList)
+        for (MObject *linkedModelObject : *newValueSet)
         {
-            if (!oldValueList->contains(linkedModelObject))
+            if (!oldValueSet.contains(linkedModelObject))
                 _reverseLinkProperty->addLink(linkedModelObject, mObject);
         }
 
-        for (MObject *linkedModelObject : *oldValueList)
+        for (MObject *linkedModelObject : oldValueSet)
         {
-            if(!newValueList->contains(linkedModelObject))
+            if(!newValueSet->contains(linkedModelObject))
                 _reverseLinkProperty->removeLink(linkedModelObject, mObject);
         }
     }
 
-    setValues(mObject, newValueList);
+    setValues(mObject, newValueSet);
 }
 
 template <> inline void MultiMapLinkPropertyInterface::updateValue(MObject *const mObject, QVariant value)
@@ -573,25 +731,13 @@ template <> inline void MultiMapLinkPropertyInterface::updateValue(MObject *cons
     if (!value.canConvert<void*>())
         return;
 
-    MObjectMultiMap *newValueMap = static_cast<MObjectMultiMap*>(value.value<void*>()),
-            *oldValueMap = mObject->getLinkPropertyValue<MObjectMultiMap>(this);
-    if (*newValueMap == *oldValueMap)
+    MObjectMultiMap *newValueMap = static_cast<MObjectMultiMap*>(value.value<void*>());
+    const MObjectMultiMap &oldValueMap = constValues(mObject);
+    if (*newValueMap == oldValueMap)
         return;
 
     if (_reverseLinkProperty)
-    {
-        for (auto it = newValueMap->cbegin() , itEnd = newValueMap->cend(); it != itEnd; ++it)
-        {
-            if (!oldValueMap->contains(it.key(), it.value()))
-                _reverseLinkProperty->addLink(it.value(), mObject);
-        }
-
-        for (auto it = oldValueMap->cbegin() , itEnd = oldValueMap->cend(); it != itEnd; ++it)
-        {
-            if(!newValueMap->contains(it.key(), it.value()))
-                _reverseLinkProperty->removeLink(it.value(), mObject);
-        }
-    }
+        _updateReverseLinks(mObject, oldValueMap, *newValueMap);
     setValues(mObject, newValueMap);
 }
 
@@ -599,14 +745,17 @@ template <> inline void MultiMapLinkPropertyInterface::updateValue(MObject *cons
 
 template <> inline void LinkToManyProperty::updateValue(MObject *const mObject, MObjectList &values)
 {
-    MObjectSet set(values.toSet());
+    MObjectSmallSet set(values);
     updateValue(mObject, QVariant::fromValue(static_cast<void*>(&set)));
 
     values = set.toList();
 }
 template <> inline void OrderedLinkToManyProperty::updateValue(MObject *const mObject, MObjectList &values)
 {
-    updateValue(mObject, QVariant::fromValue(static_cast<void*>(&values)));
+    MObjectOrderedSet orderedSet(values);
+    updateValue(mObject, QVariant::fromValue(static_cast<void*>(&orderedSet)));
+
+    values = orderedSet.toList();
 }
 template <> inline void MultiMapLinkPropertyInterface::updateValue(MObject *const mObject, MObjectList &values)
 {
@@ -621,62 +770,21 @@ template <> inline void MultiMapLinkPropertyInterface::updateValue(MObject *cons
 }
 
 
-template <> inline void LinkToManyProperty::setValueFromXMIStringIdList(MObject *mObject, const QString &ids, Model *model)
+template <> inline void MultiMapLinkPropertyInterface::addLinks(MObject *const mObject, const MObjectList &mObjectsToAdd)
 {
-    MObjectSet mObjectsToLink;
-    MObjectType *linkedEltType = mObject->getLinkedModelObjectType(this);
-    for (const QString &id_ : ids.split(" "))
+    MObjectMultiMap *values = getValues(mObject);
+    for (MObject *mObjectToAdd : mObjectsToAdd)
     {
-        QString id = id_.trimmed();
-        if (!id.isEmpty())
-        {
-            MObject *linkedModelObject = model->getModelObjectById(linkedEltType, id);
-            if (linkedModelObject)
-                mObjectsToLink.insert(linkedModelObject);
-        }
+        MapKey key = mObjectToAdd->getPropertyMapKey(this);
+        if (!values->contains(key, mObjectToAdd))
+            values->insert(key, mObjectToAdd);
     }
-    if (!mObjectsToLink.isEmpty())
-        updateValue(mObject, QVariant::fromValue(static_cast<void*>(&mObjectsToLink)));
-}
-template <> inline void OrderedLinkToManyProperty::setValueFromXMIStringIdList(MObject *mObject, const QString &ids, Model *model)
-{
-    MObjectList mObjectsToLink;
-    MObjectType *linkedEltType = mObject->getLinkedModelObjectType(this);
-    for (const QString &id_ : ids.split(" "))
-    {
-        QString id = id_.trimmed();
-        if (!id.isEmpty())
-        {
-            MObject *linkedModelObject = model->getModelObjectById(linkedEltType, id);
-            if (linkedModelObject)
-                mObjectsToLink.append(linkedModelObject);
-        }
-    }
-    if (!mObjectsToLink.isEmpty())
-        updateValue(mObject, QVariant::fromValue(static_cast<void*>(&mObjectsToLink)));
-}
-template <> inline void MultiMapLinkPropertyInterface::setValueFromXMIStringIdList(MObject *mObject, const QString &ids, Model *model)
-{
-    MObjectMultiMap mObjectsToLink;
-    MObjectType *linkedEltType = mObject->getLinkedModelObjectType(this);
-    for (const QString &id_ : ids.split(" "))
-    {
-        QString id = id_.trimmed();
-        if (!id.isEmpty())
-        {
-            MObject *linkedModelObject = model->getModelObjectById(linkedEltType, id);
-            if (linkedModelObject)
-                mObjectsToLink.insert(linkedModelObject->getPropertyMapKey(this), linkedModelObject);
-        }
-    }
-    if (!mObjectsToLink.isEmpty())
-        updateValue(mObject, QVariant::fromValue(static_cast<void*>(&mObjectsToLink)));
+    notifyValueChanged(mObject);
 }
 
 template <> inline void MultiMapLinkPropertyInterface::serializeAsXmiAttribute(XmiWriter *xmiWriter, MObject *mObject)
 {
-    MObjectMap *map = getValues(mObject);
-    xmiWriter->addAttribute(_name, getMapValuesInInsertionOrder(*map));
+    xmiWriter->addAttribute(_name, getMapValuesInInsertionOrder(constValues(mObject)));
 }
 
 ////////////////////////////////////////////////////////////////
@@ -685,7 +793,7 @@ template <> inline void MultiMapLinkPropertyInterface::serializeAsXmiAttribute(X
 
 template<typename TypeAttribute>
 AttributeProperty<TypeAttribute>::AttributeProperty(const QString &name, const char *label, const TypeAttribute &defaultValue):
-    Property(name, label), _defaultValue(defaultValue){}
+    Property(name, label, true, isUnboxedAttribute<TypeAttribute>::value), _defaultValue(defaultValue){}
 
 template<typename TypeAttribute>
 TypeAttribute AttributeProperty<TypeAttribute>::getValue(const MObject * const mObject)
@@ -693,10 +801,56 @@ TypeAttribute AttributeProperty<TypeAttribute>::getValue(const MObject * const m
     return mObject->getPropertyValue<TypeAttribute>(this);
 }
 
+template<typename TypeAttribute>
+MapKey AttributeProperty<TypeAttribute>::getMapKey(const MObject *mObject)
+{
+    if (!mObject->_propertyLayout->hasProperty(this))
+        return MapKey();
+    return MapKey(mObject->getPropertyValue<TypeAttribute>(this)); // no QVariant: native key from the typed value
+}
+
 template<typename TypeAttribute>
 void AttributeProperty<TypeAttribute>::setValue(MObject * const mObject, const TypeAttribute &value)
 {
-    mObject->setPropertyValueFromQVariant(this, QVariant::fromValue(value));
+    mObject->setPropertyValue<TypeAttribute>(this, value);
+}
+
+template<typename TypeAttribute>
+PropertyRawValue AttributeProperty<TypeAttribute>::createNewInitRawValue() const
+{
+    return _toRawValue(_defaultValue, isUnboxedAttribute<TypeAttribute>());
+}
+
+template<typename TypeAttribute>
+QVariant AttributeProperty<TypeAttribute>::toVariant(const PropertyRawValue &rawValue) const
+{
+    return _toVariant(rawValue, isUnboxedAttribute<TypeAttribute>());
+}
+
+template<typename TypeAttribute>
+PropertyRawValue AttributeProperty<TypeAttribute>::toRawValue(const QVariant &value) const
+{
+    return _toRawValue(value.value<TypeAttribute>(), isUnboxedAttribute<TypeAttribute>());
+}
+
+template<typename TypeAttribute>
+AttributeColumn *AttributeProperty<TypeAttribute>::createAttributeColumn() const
+{
+    return _createAttributeColumn(isUnboxedAttribute<TypeAttribute>());
+}
+
+template<typename TypeAttribute>
+PropertyRawValue AttributeProperty<TypeAttribute>::_toRawValue(const TypeAttribute &value, std::true_type) const
+{
+    PropertyRawValue rawValue;
+    rawValue.set<TypeAttribute>(value);
+    return rawValue;
+}
+
+template<typename TypeAttribute>
+AttributeColumn *AttributeProperty<TypeAttribute>::_createAttributeColumn(std::true_type) const
+{
+    return new TypedAttributeColumn<TypeAttribute>();
 }
 
 template<typename TypeAttribute>
@@ -0,0 +1,374 @@
+//========================================================================
+//
+// Copyright (C) 2018 Matthieu Bruel <Matthieu.Bruel@gmail.com>
+//
+// This file is a part of miniEMF++ : https://github.com/mbruel/miniEMF
+//
+// miniEMF++ is free software; you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as
+// published by the Free Software Foundation; version 3.0 of the License.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+// You should have received a copy of the GNU Lesser General Public
+// License along with this program; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301,
+// USA.
+//
+//========================================================================
+
+#ifndef PROPERTYAGGREGATOR_H
+#define PROPERTYAGGREGATOR_H
+
+#include "Model.h"
+#include "Property.h"
+#include "Utils/PureStaticClass.h"
+#include <QVector>
+#include <QtNumeric>
+#include <QDebug>
+#include <limits>
+#include <algorithm>
+
+/**
+ * @brief PropertyAggregator computes reductions (sum, mean, min, max, histogram, count)
+ * of a numeric AttributeProperty or AttributeListProperty (int, float, double)
+ * over all the MObjects of a type (and its derived types if useDerivedType)
+ *
+ * The kernels run on contiguous arrays: directly on the columns of the types
+ * that use a ColumnarStore (cf Model::enableColumnarStorage), on a gathered buffer otherwise.
+ * They are plain loops with independent accumulators so that the compiler can vectorize them.
+ *
+ * The infinite sentinels (Property::INT/FLT/DBL_INFINITE_POS/NEG) are not added as values:
+ * - sum and mean are DBL_INFINITE_POS (or NEG) if one of the values is infinite,
+ *   NaN if there are both positive and negative infinite values
+ * - min and max return them as they are the extreme values
+ * - the histogram puts them in the underflow / overflow bins
+ *
+ * The NaN values of float and double properties are skipped by the histogram (they have no bin).
+ */
+class PropertyAggregator : public PureStaticClass
+{
+public:
+    template<typename TypeAttribute, template<typename> class AttrProperty>
+    static double sum(Model *model, MObjectType *mObjectType, AttrProperty<TypeAttribute> *property, bool useDerivedType = true);
+
+    //! NaN if there are no values
+    template<typename TypeAttribute, template<typename> class AttrProperty>
+    static double mean(Model *model, MObjectType *mObjectType, AttrProperty<TypeAttribute> *property, bool useDerivedType = true);
+
+    //! ok is set to false if there are no values
+    template<typename TypeAttribute, template<typename> class AttrProperty>
+    static TypeAttribute min(Model *model, MObjectType *mObjectType, AttrProperty<TypeAttribute> *property,
+                             bool useDerivedType = true, bool *ok = nullptr);
+
+    template<typename TypeAttribute, template<typename> class AttrProperty>
+    static TypeAttribute max(Model *model, MObjectType *mObjectType, AttrProperty<TypeAttribute> *property,
+                             bool useDerivedType = true, bool *ok = nullptr);
+
+    //! nbBins+2 counters: [0] values < lowerBound, [1..nbBins] regular bins, [nbBins+1] values >= upperBound
+    template<typename TypeAttribute, template<typename> class AttrProperty>
+    static QVector<int> histogram(Model *model, MObjectType *mObjectType, AttrProperty<TypeAttribute> *property,
+                                  double lowerBound, double upperBound, int nbBins, bool useDerivedType = true);
+
+    //! number of values for which predicate(value) is true (the sentinels are given as they are)
+    template<typename TypeAttribute, template<typename> class AttrProperty, typename Predicate>
+    static int countWhere(Model *model, MObjectType *mObjectType, AttrProperty<TypeAttribute> *property,
+                          Predicate predicate, bool useDerivedType = true);
+
+private:
+    template<typename TypeAttribute> struct Traits;
+
+    struct Accumulation
+    {
+        int    nbValues      = 0;
+        int    nbInfinitePos = 0;
+        int    nbInfiniteNeg = 0;
+        double sum           = 0.;
+    };
+
+    static constexpr int sNbAccumulators = 4;
+
+    //! call kernel(values, size) on the contiguous values of each instanciable type
+    template<typename TypeAttribute, typename Kernel>
+    static void _scan(Model *model, MObjectType *mObjectType, AttributeProperty<TypeAttribute> *property,
+                      bool useDerivedType, Kernel kernel);
+
+    template<typename TypeAttribute, typename Kernel>
+    static void _scan(Model *model, MObjectType *mObjectType, AttributeListProperty<TypeAttribute> *property,
+                      bool useDerivedType, Kernel kernel);
+
+    template<typename TypeAttribute, template<typename> class AttrProperty>
+    static Accumulation _accumulate(Model *model, MObjectType *mObjectType, AttrProperty<TypeAttribute> *property, bool useDerivedType);
+
+    template<typename TypeAttribute>
+    static void _accumulateKernel(const TypeAttribute *values, int size, Accumulation &accumulation);
+
+    static double _sumWithSentinels(const Accumulation &accumulation);
+};
+
+//! accumulator of the finite values and sentinels of each numeric type
+template<> struct PropertyAggregator::Traits<int>
+{
+    using Accumulator = qint64;
+    static int infinitePos() { return Property::INT_INFINITE_POS; }
+    static int infiniteNeg() { return Property::INT_INFINITE_NEG; }
+};
+
+template<> struct PropertyAggregator::Traits<float>
+{
+    using Accumulator = double;
+    static float infinitePos() { return Property::FLT_INFINITE_POS; }
+    static float infiniteNeg() { return Property::FLT_INFINITE_NEG; }
+};
+
+template<> struct PropertyAggregator::Traits<double>
+{
+    using Accumulator = double;
+    static double infinitePos() { return Property::DBL_INFINITE_POS; }
+    static double infiniteNeg() { return Property::DBL_INFINITE_NEG; }
+};
+
+
+////////////////////////////////
+/// inline functions definition
+////////////////////////////////
+inline double PropertyAggregator::_sumWithSentinels(const Accumulation &accumulation)
+{
+    if (accumulation.nbInfinitePos && accumulation.nbInfiniteNeg)
+        return std::numeric_limits<double>::quiet_NaN();
+    else if (accumulation.nbInfinitePos)
+        return Property::DBL_INFINITE_POS;
+    else if (accumulation.nbInfiniteNeg)
+        return Property::DBL_INFINITE_NEG;
+    else
+        return accumulation.sum;
+}
+
+
+////////////////////////////////////////////
+/// Template functions definition (generic)
+////////////////////////////////////////////
+template<typename TypeAttribute, template<typename> class AttrProperty>
+double PropertyAggregator::sum(Model *model, MObjectType *mObjectType, AttrProperty<TypeAttribute> *property, bool useDerivedType)
+{
+    return _sumWithSentinels(_accumulate(model, mObjectType, property, useDerivedType));
+}
+
+template<typename TypeAttribute, template<typename> class AttrProperty>
+double PropertyAggregator::mean(Model *model, MObjectType *mObjectType, AttrProperty<TypeAttribute> *property, bool useDerivedType)
+{
+    Accumulation accumulation = _accumulate(model, mObjectType, property, useDerivedType);
+    if (accumulation.nbValues == 0)
+        return std::numeric_limits<double>::quiet_NaN();
+
+    double sum = _sumWithSentinels(accumulation);
+    if (accumulation.nbInfinitePos || accumulation.nbInfiniteNeg)
+        return sum; // infinite or NaN
+    else
+        return sum / accumulation.nbValues;
+}
+
+template<typename TypeAttribute, template<typename> class AttrProperty>
+TypeAttribute PropertyAggregator::min(Model *model, MObjectType *mObjectType, AttrProperty<TypeAttribute> *property,
+                                      bool useDerivedType, bool *ok)
+{
+    static_assert(std::is_arithmetic<TypeAttribute>::value, "PropertyAggregator only works on numeric properties");
+
+    bool found = false;
+    TypeAttribute result = std::numeric_limits<TypeAttribute>::max();
+    _scan(model, mObjectType, property, useDerivedType, [&result, &found](const TypeAttribute *values, int size){
+        TypeAttribute mins[sNbAccumulators] = {result, result, result, result};
+        int i = 0;
+        for ( ; i + sNbAccumulators <= size ; i += sNbAccumulators)
+        {
+            for (int j = 0 ; j < sNbAccumulators ; ++j)
+                mins[j] = std::min(mins[j], values[i+j]);
+        }
+        for ( ; i < size ; ++i)
+            mins[0] = std::min(mins[0], values[i]);
+
+        result = std::min(std::min(mins[0], mins[1]), std::min(mins[2], mins[3]));
+        found  = true;
+    });
+
+    if (ok)
+        *ok = found;
+    return found ? result : TypeAttribute();
+}
+
+template<typename TypeAttribute, template<typename> class AttrProperty>
+TypeAttribute PropertyAggregator::max(Model *model, MObjectType *mObjectType, AttrProperty<TypeAttribute> *property,
+                                      bool useDerivedType, bool *ok)
+{
+    static_assert(std::is_arithmetic<TypeAttribute>::value, "PropertyAggregator only works on numeric properties");
+
+    bool found = false;
+    TypeAttribute result = std::numeric_limits<TypeAttribute>::lowest();
+    _scan(model, mObjectType, property, useDerivedType, [&result, &found](const TypeAttribute *values, int size){
+        TypeAttribute maxs[sNbAccumulators] = {result, result, result, result};
+        int i = 0;
+        for ( ; i + sNbAccumulators <= size ; i += sNbAccumulators)
+        {
+            for (int j = 0 ; j < sNbAccumulators ; ++j)
+                maxs[j] = std::max(maxs[j], values[i+j]);
+        }
+        for ( ; i < size ; ++i)
+            maxs[0] = std::max(maxs[0], values[i]);
+
+        result = std::max(std::max(maxs[0], maxs[1]), std::max(maxs[2], maxs[3]));
+        found  = true;
+    });
+
+    if (ok)
+        *ok = found;
+    return found ? result : TypeAttribute();
+}
+
+template<typename TypeAttribute, template<typename> class AttrProperty>
+QVector<int> PropertyAggregator::histogram(Model *model, MObjectType *mObjectType, AttrProperty<TypeAttribute> *property,
+                                           double lowerBound, double upperBound, int nbBins, bool useDerivedType)
+{
+    static_assert(std::is_arithmetic<TypeAttribute>::value, "PropertyAggregator only works on numeric properties");
+
+    if (nbBins <= 0 || !(upperBound > lowerBound))
+    {
+        qCritical() << "[PropertyAggregator::histogram] ERROR: invalid bins (nbBins: " << nbBins
+                    << ", bounds: [" << lowerBound << ", " << upperBound << "[)";
+        return QVector<int>();
+    }
+
+    QVector<int> bins(nbBins + 2, 0);
+    const double scale = nbBins / (upperBound - lowerBound);
+    const TypeAttribute infinitePos = Traits<TypeAttribute>::infinitePos(), infiniteNeg = Traits<TypeAttribute>::infiniteNeg();
+    _scan(model, mObjectType, property, useDerivedType, [&](const TypeAttribute *values, int size){
+        int *counts = bins.data();
+        for (int i = 0 ; i < size ; ++i)
+        {
+            const TypeAttribute value = values[i];
+            if (qIsNaN(static_cast<double>(value)))
+                continue; // static_cast<int>(NaN) is undefined
+            double pos = (static_cast<double>(value) - lowerBound) * scale;
+            int bin = pos < 0. ? 0 : (pos >= nbBins ? nbBins + 1 : static_cast<int>(pos) + 1);
+            if (value == infiniteNeg)
+                bin = 0;
+            else if (value == infinitePos)
+                bin = nbBins + 1;
+            ++counts[bin];
+        }
+    });
+    return bins;
+}
+
+template<typename TypeAttribute, template<typename> class AttrProperty, typename Predicate>
+int PropertyAggregator::countWhere(Model *model, MObjectType *mObjectType, AttrProperty<TypeAttribute> *property,
+                                   Predicate predicate, bool useDerivedType)
+{
+    static_assert(std::is_arithmetic<TypeAttribute>::value, "PropertyAggregator only works on numeric properties");
+
+    int count = 0;
+    _scan(model, mObjectType, property, useDerivedType, [&count, &predicate](const TypeAttribute *values, int size){
+        int counts[sNbAccumulators] = {0, 0, 0, 0};
+        int i = 0;
+        for ( ; i + sNbAccumulators <= size ; i += sNbAccumulators)
+        {
+            for (int j = 0 ; j < sNbAccumulators ; ++j)
+                counts[j] += predicate(values[i+j]) ? 1 : 0;
+        }
+        for ( ; i < size ; ++i)
+            counts[0] += predicate(values[i]) ? 1 : 0;
+
+        count += counts[0] + counts[1] + counts[2] + counts[3];
+    });
+    return count;
+}
+
+template<typename TypeAttribute, typename Kernel>
+void PropertyAggregator::_scan(Model *model, MObjectType *mObjectType, AttributeProperty<TypeAttribute> *property,
+                               bool useDerivedType, Kernel kernel)
+{
+    QVector<TypeAttribute> buffer;
+    model->_materializeModelObjects(mObjectType, useDerivedType); // before using the columns
+    for (MObjectType *eltType : model->_getInstanciableTypes(mObjectType, useDerivedType))
+    {
+        const QVector<TypeAttribute> *column = model->getColumn(eltType, property);
+        if (column)
+        {
+            if (!column->isEmpty())
+                kernel(column->constData(), column->size());
+        }
+        else
+        {
+            buffer.resize(0);
+            model->forEachValue(eltType, property, [&buffer](const TypeAttribute &value){ buffer.append(value); });
+            if (!buffer.isEmpty())
+                kernel(buffer.constData(), buffer.size());
+        }
+    }
+}
+
+template<typename TypeAttribute, typename Kernel>
+void PropertyAggregator::_scan(Model *model, MObjectType *mObjectType, AttributeListProperty<TypeAttribute> *property,
+                               bool useDerivedType, Kernel kernel)
+{
+    QVector<TypeAttribute> buffer;
+    model->forEachModelObject(mObjectType, [&buffer, property](MObject *mObj){
+        for (const TypeAttribute &value : property->getValue(mObj))
+            buffer.append(value);
+    }, useDerivedType);
+    if (!buffer.isEmpty())
+        kernel(buffer.constData(), buffer.size());
+}
+
+template<typename TypeAttribute, template<typename> class AttrProperty>
+PropertyAggregator::Accumulation PropertyAggregator::_accumulate(Model *model, MObjectType *mObjectType,
+                                                                 AttrProperty<TypeAttribute> *property, bool useDerivedType)
+{
+    static_assert(std::is_arithmetic<TypeAttribute>::value, "PropertyAggregator only works on numeric properties");
+
+    Accumulation accumulation;
+    _scan(model, mObjectType, property, useDerivedType, [&accumulation](const TypeAttribute *values, int size){
+        _accumulateKernel(values, size, accumulation);
+    });
+    return accumulation;
+}
+
+template<typename TypeAttribute>
+void PropertyAggregator::_accumulateKernel(const TypeAttribute *values, int size, Accumulation &accumulation)
+{
+    using Accumulator = typename Traits<TypeAttribute>::Accumulator;
+    const TypeAttribute infinitePos = Traits<TypeAttribute>::infinitePos(), infiniteNeg = Traits<TypeAttribute>::infiniteNeg();
+
+    // independent accumulators (the floating point additions can't be reordered by the compiler)
+    Accumulator sums[sNbAccumulators]  = {0, 0, 0, 0};
+    int         nbPos[sNbAccumulators] = {0, 0, 0, 0};
+    int         nbNeg[sNbAccumulators] = {0, 0, 0, 0};
+    int i = 0;
+    for ( ; i + sNbAccumulators <= size ; i += sNbAccumulators)
+    {
+        for (int j = 0 ; j < sNbAccumulators ; ++j)
+        {
+            const TypeAttribute value = values[i+j];
+            const bool isPos = value == infinitePos, isNeg = value == infiniteNeg;
+            nbPos[j] += isPos;
+            nbNeg[j] += isNeg;
+            sums[j]  += (isPos | isNeg) ? Accumulator(0) : static_cast<Accumulator>(value);
+        }
+    }
+    for ( ; i < size ; ++i)
+    {
+        const TypeAttribute value = values[i];
+        const bool isPos = value == infinitePos, isNeg = value == infiniteNeg;
+        nbPos[0] += isPos;
+        nbNeg[0] += isNeg;
+        sums[0]  += (isPos | isNeg) ? Accumulator(0) : static_cast<Accumulator>(value);
+    }
+
+    accumulation.nbValues      += size;
+    accumulation.nbInfinitePos += nbPos[0] + nbPos[1] + nbPos[2] + nbPos[3];
+    accumulation.nbInfiniteNeg += nbNeg[0] + nbNeg[1] + nbNeg[2] + nbNeg[3];
+    accumulation.sum           += static_cast<double>((sums[0] + sums[1]) + (sums[2] + sums[3]));
+}
+
+#endif // PROPERTYAGGREGATOR_H
@@ -20,6 +20,7 @@
 //========================================================================
 
 #include "PropertyFactory.h"
+#include <QHash>
 
 void PropertyFactory::initModelObjectProperties()
 {
@@ -29,6 +30,9 @@ void PropertyFactory::initModelObjectProperties()
 
 void PropertyFactory::initProperties()
 {
+    // place the values of the properties in the MObjects storage
+    _assignPropertySlots();
+
     // define the EcoreContainment properties (Ecore Model)
     defineEcoreContainmentProperties();
 
@@ -43,6 +47,9 @@ void PropertyFactory::initProperties()
 
 
     defineModelObjectTypeContainerProperties();
+
+    // the metamodel is complete: the MObjects can share their layouts without lock
+    PropertyLayout::createLayouts(_classPropertyMaps);
 }
 
 void PropertyFactory::linkReverseProperties(LinkProperty * const linkProperty, LinkProperty * const reverseLinkProperty)
@@ -50,3 +57,61 @@ void PropertyFactory::linkReverseProperties(LinkProperty * const linkProperty, L
     linkProperty->setReverseLinkProperty(reverseLinkProperty);
     reverseLinkProperty->setReverseLinkProperty(linkProperty);
 }
+
+void PropertyFactory::_addProperty(QMap<QString, Property *> *propertyMap, Property *property)
+{
+    MObject::addPropertyToMap(propertyMap, property);
+    if (!_classPropertyMapSet.contains(propertyMap))
+    {
+        _classPropertyMapSet.insert(propertyMap);
+        _classPropertyMaps.append(propertyMap);
+    }
+}
+
+void PropertyFactory::_assignPropertySlots()
+{
+    // A Property can be shared by several classes (MObject::PROPERTY_NAME, inherited properties...)
+    // it must have the same slot in all of them.
+    // We take the properties in their order of appearance (parent classes are defined first)
+    // and give them the first slot free in all the classes using them.
+    // The unboxed properties and the LinkToManyProperty have their own slots (cf MObject::_rawPropertyValues and _smallSetValues)
+    QList<Property*> properties;
+    QHash<Property*, QList<QMap<QString, Property*>*>> classesOfProperty;
+    properties.append(MObject::PROPERTY_NAME); // always in slot 0
+    for (QMap<QString, Property*> *classPropertyMap : _classPropertyMaps)
+    {
+        for (Property *property : *classPropertyMap)
+        {
+            if (!classesOfProperty.contains(property) && property != MObject::PROPERTY_NAME)
+                properties.append(property);
+            classesOfProperty[property].append(classPropertyMap);
+        }
+    }
+
+    QHash<QMap<QString, Property*>*, QSet<int>> usedSlots, usedRawSlots, usedSmallSetSlots;
+    for (Property *property : properties)
+    {
+        QHash<QMap<QString, Property*>*, QSet<int>> &used = property->isUnboxed() ? usedRawSlots
+                                                          : (property->isSmallSetLink() ? usedSmallSetSlots : usedSlots);
+        const QList<QMap<QString, Property*>*> &classPropertyMaps = classesOfProperty[property];
+        int slot = 0;
+        bool isFree = false;
+        while (!isFree)
+        {
+            isFree = true;
+            for (QMap<QString, Property*> *classPropertyMap : classPropertyMaps)
+            {
+                if (used[classPropertyMap].contains(slot))
+                {
+                    isFree = false;
+                    ++slot;
+                    break;
+                }
+            }
+        }
+
+        property->_slot = slot;
+        for (QMap<QString, Property*> *classPropertyMap : classPropertyMaps)
+            used[classPropertyMap].insert(slot);
+    }
+}
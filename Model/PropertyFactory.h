@@ -25,6 +25,8 @@
 #include "Model/Property.h"
 #include "Model/MObject.h"
 #include <QMap>
+#include <QList>
+#include <QSet>
 
 class PropertyFactory
 {
@@ -46,6 +48,8 @@ protected:
     template< typename PropertyType>     PropertyType     *_create(QMap<QString, Property*> *propertyMap, const QString &name, const char *label);
     template< typename LinkPropertyType> LinkPropertyType *_create(QMap<QString, Property*> *propertyMap, MObjectType *const eltType, MObjectType *const linkedEltType, const QString &name, const char *label, bool isMandatory, bool isSerializable = true);
 
+    void _addProperty(QMap<QString, Property*> *propertyMap, Property *property);
+
 
     // Ecore specific methods (generated)
     virtual void linkAllReverseProperties() = 0;
@@ -53,6 +57,12 @@ protected:
     virtual void defineEcoreContainmentProperties() = 0;
     virtual void defineModelObjectTypeContainerProperties() = 0;
     virtual void defineMapPropertiesKey() = 0;
+
+private:
+    void _assignPropertySlots();
+
+    QList<QMap<QString, Property*>*> _classPropertyMaps;    //!< in their creation order (parent classes first)
+    QSet<QMap<QString, Property*>*>  _classPropertyMapSet;
 };
 
 
@@ -60,21 +70,21 @@ template< typename TypeAttribute, template< typename > class AttributeProperty>
 AttributeProperty<TypeAttribute> *PropertyFactory::_create(QMap<QString, Property *> *propertyMap, const QString &name, const char *label, const TypeAttribute &defaultValue)
 {
     AttributeProperty<TypeAttribute> *property = new AttributeProperty<TypeAttribute>(name, label, defaultValue);
-    MObject::addPropertyToMap(propertyMap, property);
+    _addProperty(propertyMap, property);
     return property;
 }
 
 template< typename PropertyType> PropertyType *PropertyFactory::_create(QMap<QString, Property *> *propertyMap, const QString &name, const char *label)
 {
     PropertyType* property = new PropertyType(name, label);
-    MObject::addPropertyToMap(propertyMap, property);
+    _addProperty(propertyMap, property);
     return property;
 }
 
 template< typename LinkPropertyType> LinkPropertyType *PropertyFactory::_create(QMap<QString, Property *> *propertyMap, MObjectType * const eltType, MObjectType * const linkedEltType, const QString &name, const char *label, bool isMandatory, bool isSerializable)
 {
     LinkPropertyType *property = new LinkPropertyType(eltType, linkedEltType, name, label, isMandatory, isSerializable);
-    MObject::addPropertyToMap(propertyMap, property);
+    _addProperty(propertyMap, property);
     return property;
 }
 
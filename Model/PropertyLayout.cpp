@@ -0,0 +1,157 @@
+//========================================================================
+//
+// Copyright (C) 2018 Matthieu Bruel <Matthieu.Bruel@gmail.com>
+//
+// This file is a part of miniEMF++ : https://github.com/mbruel/miniEMF
+//
+// miniEMF++ is free software; you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as
+// published by the Free Software Foundation; version 3.0 of the License.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+// You should have received a copy of the GNU Lesser General Public
+// License along with this program; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301,
+// USA.
+//
+//========================================================================
+
+#include "PropertyLayout.h"
+#include "Property.h"
+#include <QMutexLocker>
+#include <QDebug>
+
+QAtomicPointer<PropertyLayout::LayoutHash> PropertyLayout::sLayouts;
+QMutex                                     PropertyLayout::sLayoutsMutex;
+
+const PropertyLayout *PropertyLayout::getLayout(QMap<QString, Property *> *classPropertyMap)
+{
+    const LayoutHash *layouts = sLayouts.loadAcquire();
+    PropertyLayout   *layout  = layouts ? layouts->value(classPropertyMap, nullptr) : nullptr;
+    if (!layout) // a class without its own properties (not seen by the PropertyFactory)
+    {
+        createLayouts({classPropertyMap});
+        layout = sLayouts.loadAcquire()->value(classPropertyMap, nullptr);
+    }
+    return layout;
+}
+
+void PropertyLayout::createLayouts(const QList<QMap<QString, Property *> *> &classPropertyMaps)
+{
+    QMutexLocker lock(&sLayoutsMutex);
+    const LayoutHash *layouts    = sLayouts.loadAcquire();
+    LayoutHash       *newLayouts = layouts ? new LayoutHash(*layouts) : new LayoutHash();
+    for (QMap<QString, Property*> *classPropertyMap : classPropertyMaps)
+    {
+        if (!newLayouts->contains(classPropertyMap))
+            newLayouts->insert(classPropertyMap, new PropertyLayout(classPropertyMap));
+    }
+    // the previous copy is not deleted as a reader may still use it (as the layouts, they live with the metamodel)
+    sLayouts.storeRelease(newLayouts);
+}
+
+bool PropertyLayout::hasProperty(const Property *property) const
+{
+    if (!property)
+        return false;
+
+    const QVector<Property*> &slotProperties = _slotPropertiesOf(property);
+    int slot = property->getSlot();
+    return slot >= 0 && slot < slotProperties.size() && slotProperties.at(slot) == property;
+}
+
+PropertyLayout::PropertyLayout(QMap<QString, Property *> *classPropertyMap):
+    _classPropertyMap(classPropertyMap),
+    _properties(classPropertyMap->values()),
+    _slotProperties(),
+    _rawSlotProperties(),
+    _smallSetSlotProperties(),
+    _attributeProperties(), _linkProperties(), _nonContainmentLinkProperties(),
+    _containmentProperties(), _containerProperties(),
+    _serializableLinkProperties(), _serializableContainmentProperties(), _xmiAttributeProperties(),
+    _containmentPropertyMap(), _nonContainmentPropertyMap()
+{
+    for (Property *property : _properties)
+    {
+        QVector<Property*> &slotProperties = _slotPropertiesOf(property);
+        if (property->getSlot() >= slotProperties.size())
+            slotProperties.resize(property->getSlot() + 1); // filled with nullptr
+    }
+
+    for (auto it = _properties.begin(); it != _properties.end(); )
+    {
+        Property *property = *it;
+        QVector<Property*> &slotProperties = _slotPropertiesOf(property);
+        int slot = property->getSlot();
+        if (slot != -1 && slotProperties.at(slot))
+        {   // can't happen if the Property has been created by the PropertyFactory
+            qCritical() << "[PropertyLayout] ERROR: the slot of the property " << property->getName()
+                        << " is already used by " << slotProperties.at(slot)->getName() << " => the property is ignored";
+            it = _properties.erase(it);
+            continue;
+        }
+        if (slot == -1)
+        {   // Property added by hand in the class map (not through the PropertyFactory)
+            slot = slotProperties.indexOf(nullptr);
+            if (slot == -1)
+            {
+                slot = slotProperties.size();
+                slotProperties.append(nullptr);
+            }
+            property->_slot = slot;
+        }
+        slotProperties[slot] = property;
+        ++it;
+    }
+    _classifyProperties();
+}
+
+QVector<Property *> &PropertyLayout::_slotPropertiesOf(const Property *property)
+{
+    if (property->isUnboxed())
+        return _rawSlotProperties;
+    else if (property->isSmallSetLink())
+        return _smallSetSlotProperties;
+    else
+        return _slotProperties;
+}
+
+const QVector<Property *> &PropertyLayout::_slotPropertiesOf(const Property *property) const
+{
+    return const_cast<PropertyLayout*>(this)->_slotPropertiesOf(property);
+}
+
+void PropertyLayout::_classifyProperties()
+{
+    for (Property *property : _properties)
+    {
+        if (property->isSerializable() && !property->isEcoreContainment())
+            _nonContainmentPropertyMap.insert(property->getName(), property);
+        if (property->isSerializable() && !property->isEcoreContainer() && !property->isEcoreContainment())
+            _xmiAttributeProperties.append(property);
+
+        if (property->isAttributeProperty())
+            _attributeProperties.append(property);
+        if (!property->isALinkProperty())
+            continue;
+
+        LinkProperty *linkProperty = static_cast<LinkProperty*>(property);
+        _linkProperties.append(linkProperty);
+        if (linkProperty->isSerializable())
+            _serializableLinkProperties.append(linkProperty);
+        if (linkProperty->isEcoreContainer())
+            _containerProperties.append(linkProperty);
+        if (linkProperty->isEcoreContainment())
+        {
+            _containmentProperties.append(linkProperty);
+            _containmentPropertyMap.insert(linkProperty->getName(), linkProperty);
+            if (linkProperty->isSerializable())
+                _serializableContainmentProperties.append(linkProperty);
+        }
+        else
+            _nonContainmentLinkProperties.append(linkProperty);
+    }
+}
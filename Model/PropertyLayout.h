@@ -0,0 +1,135 @@
+//========================================================================
+//
+// Copyright (C) 2018 Matthieu Bruel <Matthieu.Bruel@gmail.com>
+//
+// This file is a part of miniEMF++ : https://github.com/mbruel/miniEMF
+//
+// miniEMF++ is free software; you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as
+// published by the Free Software Foundation; version 3.0 of the License.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+// You should have received a copy of the GNU Lesser General Public
+// License along with this program; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301,
+// USA.
+//
+//========================================================================
+
+#ifndef PROPERTYLAYOUT_H
+#define PROPERTYLAYOUT_H
+
+#include "aliases.h"
+#include <QMap>
+#include <QHash>
+#include <QList>
+#include <QVector>
+#include <QMutex>
+#include <QAtomicPointer>
+
+/**
+ * @brief PropertyLayout describes how the values of a class are stored in its MObjects
+ *
+ * Each Property has a slot (assigned by PropertyFactory::initProperties) which is
+ * the index of its value in the MObject storage: the QVariant values,
+ * the PropertyRawValue ones for the unboxed properties (cf Property::isUnboxed)
+ * or the MObjectSmallSet ones for the LinkToManyProperty (cf Property::isSmallSetLink).
+ * The layout is built once per class property map (the sClassPropertyMap of the generated classes)
+ * and shared by all the instances of the class.
+ * It also classifies the properties (attributes, links, containment...) so the loops
+ * on the MObjects don't call the virtual predicates of every Property:
+ * the metamodel must be complete (reverse links and containments set) before the first MObject is created.
+ * The layouts are created by PropertyFactory::initProperties so getLayout doesn't lock (it is called by each MObject constructor).
+ */
+class PropertyLayout
+{
+public:
+    static const PropertyLayout *getLayout(QMap<QString, Property*> *classPropertyMap);
+    static void createLayouts(const QList<QMap<QString, Property*>*> &classPropertyMaps); //!< once the metamodel is complete
+
+    ~PropertyLayout() = default;
+
+    PropertyLayout(const PropertyLayout &other) = delete;
+    PropertyLayout(PropertyLayout &&other) = delete;
+
+    PropertyLayout & operator=(const PropertyLayout &other) = delete;
+    PropertyLayout & operator=(PropertyLayout &&other) = delete;
+
+    inline int nbSlots() const;
+    inline int nbRawSlots() const;
+    inline int nbSmallSetSlots() const;
+    inline Property *getPropertyAtSlot(int slot) const;
+    inline Property *getPropertyAtRawSlot(int slot) const;
+    bool hasProperty(const Property *property) const;
+
+    inline const QList<Property*> &getProperties() const; //!< sorted by name (as the class property map)
+    inline QMap<QString, Property*> *getClassPropertyMap() const;
+
+    // #### classification of the properties (in the order of getProperties) ####
+    inline const QVector<Property*>     &getAttributeProperties() const;
+    inline const QVector<LinkProperty*> &getLinkProperties() const;
+    inline const QVector<LinkProperty*> &getNonContainmentLinkProperties() const;
+    inline const QVector<LinkProperty*> &getContainmentProperties() const;
+    inline const QVector<LinkProperty*> &getContainerProperties() const;
+    inline const QVector<LinkProperty*> &getSerializableLinkProperties() const;
+    inline const QVector<LinkProperty*> &getSerializableContainmentProperties() const;
+    inline const QVector<Property*>     &getXmiAttributeProperties() const; //!< serializable, neither containment nor container
+
+    inline const QMap<QString, LinkProperty*> &getContainmentPropertyMap() const;
+    inline const QMap<QString, Property*>     &getNonContainmentPropertyMap() const; //!< serializable ones
+
+private:
+    explicit PropertyLayout(QMap<QString, Property*> *classPropertyMap);
+    void _classifyProperties();
+    QVector<Property*> &_slotPropertiesOf(const Property *property); //!< of the storage of the property
+    const QVector<Property*> &_slotPropertiesOf(const Property *property) const;
+
+    QMap<QString, Property*> *const _classPropertyMap;
+    QList<Property*>                _properties;
+    QVector<Property*>              _slotProperties;    //!< nullptr for the slots used by other classes
+    QVector<Property*>              _rawSlotProperties; //!< same for the unboxed properties
+    QVector<Property*>              _smallSetSlotProperties; //!< same for the LinkToManyProperty
+
+    QVector<Property*>              _attributeProperties;
+    QVector<LinkProperty*>          _linkProperties;
+    QVector<LinkProperty*>          _nonContainmentLinkProperties;
+    QVector<LinkProperty*>          _containmentProperties;
+    QVector<LinkProperty*>          _containerProperties;
+    QVector<LinkProperty*>          _serializableLinkProperties;
+    QVector<LinkProperty*>          _serializableContainmentProperties;
+    QVector<Property*>              _xmiAttributeProperties;
+    QMap<QString, LinkProperty*>    _containmentPropertyMap;
+    QMap<QString, Property*>        _nonContainmentPropertyMap;
+
+    typedef QHash<QMap<QString, Property*>*, PropertyLayout*> LayoutHash;
+    static QAtomicPointer<LayoutHash> sLayouts;      //!< never modified once published (read without lock)
+    static QMutex                     sLayoutsMutex; //!< to publish a new copy with more layouts
+};
+
+int PropertyLayout::nbSlots() const { return _slotProperties.size(); }
+int PropertyLayout::nbRawSlots() const { return _rawSlotProperties.size(); }
+int PropertyLayout::nbSmallSetSlots() const { return _smallSetSlotProperties.size(); }
+
+Property *PropertyLayout::getPropertyAtSlot(int slot) const { return _slotProperties.at(slot); }
+Property *PropertyLayout::getPropertyAtRawSlot(int slot) const { return _rawSlotProperties.at(slot); }
+
+const QList<Property *> &PropertyLayout::getProperties() const { return _properties; }
+
+QMap<QString, Property *> *PropertyLayout::getClassPropertyMap() const { return _classPropertyMap; }
+
+const QVector<Property*>     &PropertyLayout::getAttributeProperties()               const { return _attributeProperties; }
+const QVector<LinkProperty*> &PropertyLayout::getLinkProperties()                    const { return _linkProperties; }
+const QVector<LinkProperty*> &PropertyLayout::getNonContainmentLinkProperties()      const { return _nonContainmentLinkProperties; }
+const QVector<LinkProperty*> &PropertyLayout::getContainmentProperties()             const { return _containmentProperties; }
+const QVector<LinkProperty*> &PropertyLayout::getContainerProperties()               const { return _containerProperties; }
+const QVector<LinkProperty*> &PropertyLayout::getSerializableLinkProperties()        const { return _serializableLinkProperties; }
+const QVector<LinkProperty*> &PropertyLayout::getSerializableContainmentProperties() const { return _serializableContainmentProperties; }
+const QVector<Property*>     &PropertyLayout::getXmiAttributeProperties()            const { return _xmiAttributeProperties; }
+
+const QMap<QString, LinkProperty*> &PropertyLayout::getContainmentPropertyMap()    const { return _containmentPropertyMap; }
+const QMap<QString, Property*>     &PropertyLayout::getNonContainmentPropertyMap() const { return _nonContainmentPropertyMap; }
+
+#endif // PROPERTYLAYOUT_H
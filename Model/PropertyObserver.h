@@ -0,0 +1,44 @@
+//========================================================================
+//
+// Copyright (C) 2018 Matthieu Bruel <Matthieu.Bruel@gmail.com>
+//
+// This file is a part of miniEMF++ : https://github.com/mbruel/miniEMF
+//
+// miniEMF++ is free software; you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as
+// published by the Free Software Foundation; version 3.0 of the License.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+// You should have received a copy of the GNU Lesser General Public
+// License along with this program; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301,
+// USA.
+//
+//========================================================================
+
+#ifndef PROPERTYOBSERVER_H
+#define PROPERTYOBSERVER_H
+
+class MObject;
+class Property;
+
+/**
+ * @brief PropertyObserver is notified each time the value of a Property is changed in a MObject
+ * (cf Property::addObserver)
+ *
+ * It is used to keep up to date the structures built on the values (indexes...).
+ * The notification is done after the change, only for the MObjects held by a Model that has observers
+ * (cf Model::_hasObservers) but for all of these Models: the observer has to filter the ones it is interested in.
+ */
+class PropertyObserver
+{
+public:
+    virtual ~PropertyObserver() = default;
+
+    virtual void propertyValueChanged(MObject *mObject, Property *property) = 0;
+};
+
+#endif // PROPERTYOBSERVER_H
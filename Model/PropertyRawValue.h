@@ -0,0 +1,69 @@
+//========================================================================
+//
+// Copyright (C) 2018 Matthieu Bruel <Matthieu.Bruel@gmail.com>
+//
+// This file is a part of miniEMF++ : https://github.com/mbruel/miniEMF
+//
+// miniEMF++ is free software; you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as
+// published by the Free Software Foundation; version 3.0 of the License.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+// You should have received a copy of the GNU Lesser General Public
+// License along with this program; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301,
+// USA.
+//
+//========================================================================
+
+#ifndef PROPERTYRAWVALUE_H
+#define PROPERTYRAWVALUE_H
+
+#include <type_traits>
+
+//! the AttributeProperty types that are stored unboxed (without QVariant) in the MObjects
+template<typename TypeAttribute> struct isUnboxedAttribute : std::false_type {};
+template<> struct isUnboxedAttribute<bool>   : std::true_type {};
+template<> struct isUnboxedAttribute<int>    : std::true_type {};
+template<> struct isUnboxedAttribute<float>  : std::true_type {};
+template<> struct isUnboxedAttribute<double> : std::true_type {};
+
+/**
+ * @brief PropertyRawValue is the storage of an unboxed attribute
+ * only the isUnboxedAttribute types can be read or written (the AttributeProperty dispatch on it)
+ */
+union PropertyRawValue
+{
+    bool   b;
+    int    i;
+    float  f;
+    double d;
+
+    PropertyRawValue() : d(0.) {}
+
+    template<typename TypeAttribute> inline TypeAttribute get() const
+    {
+        static_assert(isUnboxedAttribute<TypeAttribute>::value, "PropertyRawValue only stores bool, int, float and double");
+        return TypeAttribute();
+    }
+    template<typename TypeAttribute> inline void set(const TypeAttribute &value)
+    {
+        static_assert(isUnboxedAttribute<TypeAttribute>::value, "PropertyRawValue only stores bool, int, float and double");
+        (void)value;
+    }
+};
+
+template<> inline bool   PropertyRawValue::get<bool>()   const { return b; }
+template<> inline int    PropertyRawValue::get<int>()    const { return i; }
+template<> inline float  PropertyRawValue::get<float>()  const { return f; }
+template<> inline double PropertyRawValue::get<double>() const { return d; }
+
+template<> inline void PropertyRawValue::set<bool>(const bool &value)     { b = value; }
+template<> inline void PropertyRawValue::set<int>(const int &value)       { i = value; }
+template<> inline void PropertyRawValue::set<float>(const float &value)   { f = value; }
+template<> inline void PropertyRawValue::set<double>(const double &value) { d = value; }
+
+#endif // PROPERTYRAWVALUE_H
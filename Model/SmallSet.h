@@ -0,0 +1,286 @@
+//========================================================================
+//
+// Copyright (C) 2018 Matthieu Bruel <Matthieu.Bruel@gmail.com>
+//
+// This file is a part of miniEMF++ : https://github.com/mbruel/miniEMF
+//
+// miniEMF++ is free software; you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as
+// published by the Free Software Foundation; version 3.0 of the License.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+// You should have received a copy of the GNU Lesser General Public
+// License along with this program; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301,
+// USA.
+//
+//========================================================================
+
+#ifndef SMALLSET_H
+#define SMALLSET_H
+
+#include <QSet>
+#include <QList>
+#include <utility>
+
+/**
+ * @brief SmallSet is a set that keeps up to sInlineCapacity values inline (no heap allocation)
+ * and switches to a QSet above (used for the unordered links: LinkToManyProperty)
+ *
+ * Most of the to-many links have only a few values.
+ * The MObjects hold them inline (cf MObject::_smallSetValues): no allocation until the link exceeds sInlineCapacity.
+ * It goes back inline when the QSet shrinks to half the inline capacity.
+ * The inline values are iterated in insertion order (until a removal).
+ */
+template <typename T> class SmallSet
+{
+public:
+    static const int sInlineCapacity = 4;
+
+    class const_iterator
+    {
+    public:
+        inline explicit const_iterator(const T *inlineValue);
+        inline explicit const_iterator(typename QSet<T>::const_iterator it);
+
+        inline const T &operator*() const;
+        inline const_iterator &operator++();
+        inline bool operator==(const const_iterator &other) const;
+        inline bool operator!=(const const_iterator &other) const;
+
+    private:
+        const T                          *_inlineValue; //!< nullptr when iterating the QSet
+        typename QSet<T>::const_iterator  _it;
+    };
+
+    inline SmallSet();
+    SmallSet(const SmallSet &other);
+    inline SmallSet(SmallSet &&other);
+    explicit SmallSet(const QList<T> &values);
+    inline ~SmallSet();
+
+    inline SmallSet & operator=(SmallSet other);
+
+    inline int  size() const;
+    inline bool isEmpty() const;
+    inline bool isInline() const;
+    bool contains(const T &value) const;
+
+    bool insert(const T &value); //!< false if it was already in
+    bool remove(const T &value);
+    inline void clear();
+    void swap(SmallSet &other);
+
+    QList<T> toList() const;
+
+    bool operator==(const SmallSet &other) const;
+    inline bool operator!=(const SmallSet &other) const;
+
+    inline const_iterator begin() const;
+    inline const_iterator end() const;
+    inline const_iterator cbegin() const;
+    inline const_iterator cend() const;
+
+private:
+    void _toSet();
+    void _toInline();
+
+    int      _size;                    //!< number of inline values (when !_set)
+    T        _inline[sInlineCapacity];
+    QSet<T> *_set;                     //!< only above sInlineCapacity
+};
+
+
+////////////////////////////////
+/// inline functions definition
+////////////////////////////////
+template <typename T> SmallSet<T>::SmallSet() : _size(0), _inline(), _set(nullptr) {}
+template <typename T> SmallSet<T>::SmallSet(SmallSet &&other) : SmallSet() { swap(other); }
+template <typename T> SmallSet<T>::~SmallSet() { delete _set; }
+
+template <typename T> SmallSet<T> & SmallSet<T>::operator=(SmallSet other)
+{
+    swap(other);
+    return *this;
+}
+
+template <typename T> int  SmallSet<T>::size()     const { return _set ? _set->size() : _size; }
+template <typename T> bool SmallSet<T>::isEmpty()  const { return size() == 0; }
+template <typename T> bool SmallSet<T>::isInline() const { return _set == nullptr; }
+template <typename T> bool SmallSet<T>::operator!=(const SmallSet &other) const { return !(*this == other); }
+
+template <typename T> void SmallSet<T>::clear()
+{
+    delete _set;
+    _set  = nullptr;
+    _size = 0;
+}
+
+template <typename T> typename SmallSet<T>::const_iterator SmallSet<T>::begin() const
+{
+    return _set ? const_iterator(_set->cbegin()) : const_iterator(_inline);
+}
+template <typename T> typename SmallSet<T>::const_iterator SmallSet<T>::end() const
+{
+    return _set ? const_iterator(_set->cend()) : const_iterator(_inline + _size);
+}
+template <typename T> typename SmallSet<T>::const_iterator SmallSet<T>::cbegin() const { return begin(); }
+template <typename T> typename SmallSet<T>::const_iterator SmallSet<T>::cend() const { return end(); }
+
+template <typename T> SmallSet<T>::const_iterator::const_iterator(const T *inlineValue) : _inlineValue(inlineValue), _it() {}
+template <typename T> SmallSet<T>::const_iterator::const_iterator(typename QSet<T>::const_iterator it) : _inlineValue(nullptr), _it(it) {}
+
+template <typename T> const T &SmallSet<T>::const_iterator::operator*() const { return _inlineValue ? *_inlineValue : *_it; }
+
+template <typename T> typename SmallSet<T>::const_iterator &SmallSet<T>::const_iterator::operator++()
+{
+    if (_inlineValue)
+        ++_inlineValue;
+    else
+        ++_it;
+    return *this;
+}
+
+template <typename T> bool SmallSet<T>::const_iterator::operator==(const const_iterator &other) const
+{
+    return _inlineValue ? _inlineValue == other._inlineValue : _it == other._it;
+}
+template <typename T> bool SmallSet<T>::const_iterator::operator!=(const const_iterator &other) const { return !(*this == other); }
+
+
+///////////////////////////////////////////////////////
+/// Template functions definition (generic)
+///
+template <typename T>
+SmallSet<T>::SmallSet(const SmallSet &other):
+    _size(other._size), _inline(), _set(other._set ? new QSet<T>(*other._set) : nullptr)
+{
+    for (int i = 0 ; i < _size ; ++i)
+        _inline[i] = other._inline[i];
+}
+
+template <typename T>
+SmallSet<T>::SmallSet(const QList<T> &values):
+    SmallSet()
+{
+    for (const T &value : values)
+        insert(value);
+}
+
+template <typename T>
+bool SmallSet<T>::contains(const T &value) const
+{
+    if (_set)
+        return _set->contains(value);
+
+    for (int i = 0 ; i < _size ; ++i)
+    {
+        if (_inline[i] == value)
+            return true;
+    }
+    return false;
+}
+
+template <typename T>
+bool SmallSet<T>::insert(const T &value)
+{
+    if (contains(value))
+        return false;
+
+    if (!_set && _size == sInlineCapacity)
+        _toSet();
+
+    if (_set)
+        _set->insert(value);
+    else
+        _inline[_size++] = value;
+    return true;
+}
+
+template <typename T>
+bool SmallSet<T>::remove(const T &value)
+{
+    if (_set)
+    {
+        if (!_set->remove(value))
+            return false;
+        if (_set->size() <= sInlineCapacity / 2)
+            _toInline();
+        return true;
+    }
+
+    for (int i = 0 ; i < _size ; ++i)
+    {
+        if (_inline[i] == value)
+        {
+            _inline[i] = _inline[--_size]; // the last one takes its place
+            _inline[_size] = T();
+            return true;
+        }
+    }
+    return false;
+}
+
+template <typename T>
+void SmallSet<T>::swap(SmallSet &other)
+{
+    std::swap(_size, other._size);
+    std::swap(_set, other._set);
+    for (int i = 0 ; i < sInlineCapacity ; ++i)
+        std::swap(_inline[i], other._inline[i]);
+}
+
+template <typename T>
+QList<T> SmallSet<T>::toList() const
+{
+    if (_set)
+        return _set->toList();
+
+    QList<T> values;
+    values.reserve(_size);
+    for (int i = 0 ; i < _size ; ++i)
+        values.append(_inline[i]);
+    return values;
+}
+
+template <typename T>
+bool SmallSet<T>::operator==(const SmallSet &other) const
+{
+    if (size() != other.size())
+        return false;
+
+    for (const T &value : *this)
+    {
+        if (!other.contains(value))
+            return false;
+    }
+    return true;
+}
+
+template <typename T>
+void SmallSet<T>::_toSet()
+{
+    _set = new QSet<T>();
+    _set->reserve(2 * sInlineCapacity);
+    for (int i = 0 ; i < _size ; ++i)
+    {
+        _set->insert(_inline[i]);
+        _inline[i] = T();
+    }
+    _size = 0;
+}
+
+template <typename T>
+void SmallSet<T>::_toInline()
+{
+    _size = 0;
+    for (const T &value : *_set)
+        _inline[_size++] = value;
+    delete _set;
+    _set = nullptr;
+}
+
+#endif // SMALLSET_H
@@ -0,0 +1,155 @@
+//========================================================================
+//
+// Copyright (C) 2018 Matthieu Bruel <Matthieu.Bruel@gmail.com>
+//
+// This file is a part of miniEMF++ : https://github.com/mbruel/miniEMF
+//
+// miniEMF++ is free software; you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as
+// published by the Free Software Foundation; version 3.0 of the License.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+// You should have received a copy of the GNU Lesser General Public
+// License along with this program; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301,
+// USA.
+//
+//========================================================================
+
+#include "ValidationCache.h"
+#include "MObject.h"
+#include "Property.h"
+#include "Utils/Parallel.h"
+#include <QVector>
+
+ValidationCache::ValidationCache(const QSet<MObjectType *> &typesToExclude):
+    _typesToExclude(typesToExclude), _observedProperties(), _modelObjects(), _dirtyModelObjects(), _errors()
+{}
+
+ValidationCache::~ValidationCache()
+{
+    for (Property *property : _observedProperties)
+        property->removeObserver(this);
+}
+
+void ValidationCache::insert(MObject *mObject)
+{
+    _observeProperties(mObject);
+    _modelObjects.insert(mObject);
+    _dirtyModelObjects.insert(mObject);
+}
+
+void ValidationCache::remove(MObject *mObject)
+{
+    if (!_modelObjects.remove(mObject))
+        return;
+
+    _dirtyModelObjects.remove(mObject);
+    _removeErrors(mObject);
+    _addLinkedModelObjects(mObject, _dirtyModelObjects); // their business rules may depend on mObject
+}
+
+void ValidationCache::clear()
+{
+    _modelObjects.clear();
+    _dirtyModelObjects.clear();
+    _errors.clear();
+}
+
+void ValidationCache::validateDirtyModelObjects(bool inParallel)
+{
+    if (_dirtyModelObjects.isEmpty())
+        return;
+
+    // the linked MObjects of the dirty ones are validated too
+    MObjectSet toValidate(_dirtyModelObjects);
+    if (_dirtyModelObjects.size() < _modelObjects.size())
+    {
+        for (MObject *mObject : _dirtyModelObjects)
+            _addLinkedModelObjects(mObject, toValidate);
+    }
+    _dirtyModelObjects.clear();
+
+    QVector<MObject*>    mObjects;
+    mObjects.reserve(toValidate.size());
+    for (MObject *mObject : toValidate)
+        mObjects.append(mObject);
+    QVector<QStringList> mObjectErrors(mObjects.size());
+    auto validateModelObject = [this, &mObjects, &mObjectErrors](int idx){
+        MObject *mObject = mObjects.at(idx);
+        mObject->validateLinkProperties(mObjectErrors[idx]);
+        if (!_typesToExclude.contains(mObject->getModelObjectType()))
+            mObject->validateBusinessRules(mObjectErrors[idx]);
+    };
+
+    if (inParallel && mObjects.size() >= sParallelThreshold)
+        Parallel::forEach(mObjects.size(), validateModelObject);
+    else
+    {
+        for (int idx = 0 ; idx < mObjects.size() ; ++idx)
+            validateModelObject(idx);
+    }
+
+    for (int idx = 0 ; idx < mObjects.size() ; ++idx)
+    {
+        MObject *mObject = mObjects.at(idx);
+        if (mObjectErrors.at(idx).isEmpty())
+            _removeErrors(mObject);
+        else
+            _errors[mObject->getModelObjectType()].insert(mObject->getId(), mObjectErrors.at(idx));
+    }
+}
+
+void ValidationCache::getErrors(QStringList &compilationErrors) const
+{
+    for (auto itType = _errors.cbegin(), itTypeEnd = _errors.cend() ; itType != itTypeEnd ; ++itType)
+    {
+        for (const QStringList &errors : itType.value())
+            compilationErrors.append(errors);
+    }
+}
+
+void ValidationCache::propertyValueChanged(MObject *mObject, Property *property)
+{
+    Q_UNUSED(property);
+    if (_modelObjects.contains(mObject))
+        _dirtyModelObjects.insert(mObject);
+}
+
+void ValidationCache::_observeProperties(MObject *mObject)
+{
+    for (Property *property : mObject->getPropertyList())
+    {
+        if (!_observedProperties.contains(property))
+        {
+            property->addObserver(this);
+            _observedProperties.insert(property);
+        }
+    }
+}
+
+void ValidationCache::_addLinkedModelObjects(MObject *mObject, MObjectSet &mObjects) const
+{
+    for (LinkProperty *linkProperty : mObject->getLinkProperties())
+    {
+        for (MObject *linkedObj : linkProperty->getLinkedModelObjects(mObject))
+        {
+            if (_modelObjects.contains(linkedObj))
+                mObjects.insert(linkedObj);
+        }
+    }
+}
+
+void ValidationCache::_removeErrors(MObject *mObject)
+{
+    auto itType = _errors.find(mObject->getModelObjectType());
+    if (itType != _errors.end())
+    {
+        itType.value().remove(mObject->getId());
+        if (itType.value().isEmpty())
+            _errors.erase(itType);
+    }
+}
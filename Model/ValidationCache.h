@@ -0,0 +1,82 @@
+//========================================================================
+//
+// Copyright (C) 2018 Matthieu Bruel <Matthieu.Bruel@gmail.com>
+//
+// This file is a part of miniEMF++ : https://github.com/mbruel/miniEMF
+//
+// miniEMF++ is free software; you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as
+// published by the Free Software Foundation; version 3.0 of the License.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+// You should have received a copy of the GNU Lesser General Public
+// License along with this program; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301,
+// USA.
+//
+//========================================================================
+
+#ifndef VALIDATIONCACHE_H
+#define VALIDATIONCACHE_H
+
+#include "aliases.h"
+#include "PropertyObserver.h"
+#include <QSet>
+#include <QMap>
+#include <QStringList>
+
+class MObjectType;
+
+/**
+ * @brief ValidationCache keeps the validation errors of each MObject of a Model
+ * (cf Model::incrementalValidate)
+ *
+ * It observes the Properties of the MObjects it holds: a changed MObject becomes dirty
+ * (the reverse links are updated through the Properties so both ends are dirty).
+ * Only the dirty MObjects and their linked MObjects are validated again.
+ */
+class ValidationCache : public PropertyObserver
+{
+public:
+    ValidationCache(const QSet<MObjectType*> &typesToExclude);
+    ~ValidationCache() override;
+
+    ValidationCache(const ValidationCache &other) = delete;
+    ValidationCache(ValidationCache &&other) = delete;
+
+    ValidationCache & operator=(const ValidationCache &other) = delete;
+    ValidationCache & operator=(ValidationCache &&other) = delete;
+
+    inline const QSet<MObjectType*> &getTypesToExclude() const;
+    inline bool hasDirtyModelObjects() const;
+
+    void insert(MObject *mObject); //!< dirty until the next validateDirtyModelObjects
+    void remove(MObject *mObject);
+    void clear(); //!< remove all the MObjects and their errors
+
+    void validateDirtyModelObjects(bool inParallel);
+    void getErrors(QStringList &compilationErrors) const; //!< same order than Model::validate
+
+    void propertyValueChanged(MObject *mObject, Property *property) override;
+
+private:
+    void _observeProperties(MObject *mObject);
+    void _addLinkedModelObjects(MObject *mObject, MObjectSet &mObjects) const; //!< only the ones we hold
+    void _removeErrors(MObject *mObject);
+
+    static const int sParallelThreshold = 512; //!< minimum number of dirty MObjects to go parallel
+
+    const QSet<MObjectType*> _typesToExclude;
+    QSet<Property*>          _observedProperties;
+    MObjectSet               _modelObjects;
+    MObjectSet               _dirtyModelObjects;
+    QMap<MObjectType*, QMap<ElemId, QStringList> > _errors; //!< only the MObjects with errors
+};
+
+const QSet<MObjectType *> &ValidationCache::getTypesToExclude() const { return _typesToExclude; }
+bool ValidationCache::hasDirtyModelObjects() const { return !_dirtyModelObjects.isEmpty(); }
+
+#endif // VALIDATIONCACHE_H
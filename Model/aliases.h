@@ -4,6 +4,8 @@
 #include <QString>
 #include <QDateTime>
 #include <QVariant>
+#include "ElemId.h"
+#include "MapKey.h"
 
 class MObject;
 class Property;
@@ -34,25 +36,28 @@ using Link01Property = LinkToOneProperty;
 using Link11Property = LinkToOneProperty;
 
 template <template <typename...> class Container, typename... Args> class GenericLinkToManyProperty;
+template <typename T> class OrderedSet;
+template <typename T> class SmallSet;
 class MapLinkProperty;
 
-using LinkToManyProperty            = GenericLinkToManyProperty<QSet>;
+using LinkToManyProperty            = GenericLinkToManyProperty<SmallSet>;
 using Link0NProperty                = LinkToManyProperty;
 using Link1NProperty                = LinkToManyProperty;
 using SetProperty                   = LinkToManyProperty;
-using OrderedLinkToManyProperty     = GenericLinkToManyProperty<QList>;
-using OrderedLink0NProperty         = GenericLinkToManyProperty<QList>;
-using OrderedLink1NProperty         = GenericLinkToManyProperty<QList>;
-using ListProperty                  = GenericLinkToManyProperty<QList>;
-using MultiMapLinkPropertyInterface = GenericLinkToManyProperty<QMultiMap, QVariant>;
+using OrderedLinkToManyProperty     = GenericLinkToManyProperty<OrderedSet>;
+using OrderedLink0NProperty         = GenericLinkToManyProperty<OrderedSet>;
+using OrderedLink1NProperty         = GenericLinkToManyProperty<OrderedSet>;
+using ListProperty                  = GenericLinkToManyProperty<OrderedSet>;
+using MultiMapLinkPropertyInterface = GenericLinkToManyProperty<QMultiMap, MapKey>;
 using Map1NLinkProperty             = MapLinkProperty;
 using MultiMapLinkProperty          = MapLinkProperty;
 
-using ElemId          = QString;
-using MObjectSet      = QSet<MObject*>;
-using MObjectList     = QList<MObject*>;
-using MObjectMap      = QMultiMap<QVariant, MObject*>;
-using MObjectMultiMap = QMultiMap<QVariant, MObject*>;
+using MObjectSet        = QSet<MObject*>;
+using MObjectList       = QList<MObject*>;
+using MObjectOrderedSet = OrderedSet<MObject*>;
+using MObjectSmallSet   = SmallSet<MObject*>;
+using MObjectMap        = QMultiMap<MapKey, MObject*>;
+using MObjectMultiMap   = QMultiMap<MapKey, MObject*>;
 
 
 #endif // ALIASES_H
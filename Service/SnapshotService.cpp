@@ -0,0 +1,837 @@
+//========================================================================
+//
+// Copyright (C) 2018 Matthieu Bruel <Matthieu.Bruel@gmail.com>
+//
+// This file is a part of miniEMF++ : https://github.com/mbruel/miniEMF
+//
+// miniEMF++ is free software; you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as
+// published by the Free Software Foundation; version 3.0 of the License.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+// You should have received a copy of the GNU Lesser General Public
+// License along with this program; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301,
+// USA.
+//
+//========================================================================
+
+#include "SnapshotService.h"
+#include "Model/Model.h"
+#include "Model/Property.h"
+#include "Utils/XmiWriter.h"
+
+#include <QFile>
+#include <QHash>
+#include <QMultiHash>
+#include <QVector>
+#include <QDebug>
+#include <cstring>
+#include <algorithm>
+
+const char SnapshotService::sMagic[8] = {'m', 'i', 'n', 'i', 'E', 'M', 'F', 'S'};
+
+namespace
+{
+// Snapshot format (native byte order, each section is aligned on 8 bytes):
+//   Header
+//   TypeRecord     [nbTypes]      the instanciable types that have MObjects
+//   PropertyRecord [nbProperties] the properties of each type (cf TypeRecord::firstProperty)
+//   quint64        [nbObjects]    the ids of the MObjects grouped by type (cf TypeRecord::firstObject), sorted as in the Model
+//                                 so the packed ones are increasing and before the interned ones (cf MappedSnapshot::findModelObject)
+//   quint64        [nbValues]     the slots of the MObjects: one per property of their type (cf TypeRecord::firstValue)
+//   quint32        [nbLinks]      the indexes of the linked MObjects (adjacency arrays)
+//   StringRecord   [nbStrings]    the strings (names of the types and properties, values, interned ids)
+//   QChar          [poolSize]     the characters of the strings
+struct Header
+{
+    char    magic[8];
+    quint32 version;
+    quint32 byteOrder;
+    quint32 nbTypes;
+    quint32 nbProperties;
+    quint32 nbObjects;
+    quint32 nbLinks;
+    quint32 nbStrings;
+    quint32 poolSize;
+    quint64 nbValues;
+    quint64 typeOffset;
+    quint64 propertyOffset;
+    quint64 objectOffset;
+    quint64 valueOffset;
+    quint64 linkOffset;
+    quint64 stringOffset;
+    quint64 poolOffset;
+    quint64 fileSize;
+};
+
+struct TypeRecord
+{
+    quint32 name;
+    quint32 firstProperty;
+    quint32 nbProperties;
+    quint32 firstObject;
+    quint32 nbObjects;
+    quint32 padding;
+    quint64 firstValue;
+};
+
+enum class SLOT_KIND : quint32 {
+    RAW_ATTRIBUTE,    //!< PropertyRawValue
+    STRING_ATTRIBUTE, //!< index of the xmi value in the strings (sNoString: not serialized)
+    LINKS             //!< first link (32 high bits) and number of links (32 low bits)
+};
+
+struct PropertyRecord
+{
+    quint32 name;
+    quint32 kind;
+};
+
+struct StringRecord
+{
+    quint32 offset;
+    quint32 size;
+};
+
+const quint32 sByteOrder      = 0x01020304;
+const quint32 sNoString       = 0xFFFFFFFF;
+const quint32 sNoRecord       = 0xFFFFFFFF;
+const quint64 sInternedIdFlag = Q_UINT64_C(1) << 63; //!< the id is the index of its string (never set in a packed ElemId)
+
+static_assert(sizeof(PropertyRawValue) == sizeof(quint64), "a raw value should fit in a slot");
+
+quint64 align8(quint64 offset) { return (offset + 7) & ~Q_UINT64_C(7); }
+
+//! the strings of the snapshot (each one is only stored once)
+class StringPool
+{
+public:
+    quint32 add(const QString &str)
+    {
+        auto it = _indexes.constFind(str);
+        if (it != _indexes.cend())
+            return it.value();
+
+        quint32 index = static_cast<quint32>(_records.size());
+        StringRecord record = {static_cast<quint32>(_pool.size()), static_cast<quint32>(str.size())};
+        _records.append(record);
+        _pool += str;
+        _indexes.insert(str, index);
+        return index;
+    }
+
+    const QVector<StringRecord> &records() const { return _records; }
+    const QString               &pool()    const { return _pool; }
+
+private:
+    QHash<QString, quint32> _indexes;
+    QVector<StringRecord>   _records;
+    QString                 _pool; //!< the characters of all the strings
+};
+
+//! catch the value that an AttributeProperty would write in the xmi
+class XmiValueCatcher : public XmiWriter
+{
+public:
+    XmiValueCatcher() : XmiWriter(nullptr, static_cast<QXmlStreamWriter*>(nullptr)), _value(), _hasValue(false) {}
+
+    using XmiWriter::addAttribute;
+    void addAttribute(const QString &name, const QString &value) override
+    {
+        _hasValue = !(name.isEmpty() || value.isEmpty());
+        _value    = value.trimmed();
+    }
+
+    bool catchValue(Property *property, MObject *mObject)
+    {
+        _hasValue = false;
+        property->serializeAsXmiAttribute(this, mObject);
+        return _hasValue;
+    }
+    const QString &value() const { return _value; }
+
+private:
+    QString _value;
+    bool    _hasValue;
+};
+}
+
+PropertyRawValue SnapshotService::_getRawValue(const MObject *mObject, const Property *property)
+{
+    return mObject->_getRawValue(property);
+}
+
+void SnapshotService::_setRawValue(MObject *mObject, const Property *property, const PropertyRawValue &rawValue)
+{
+    mObject->_setRawValue(property, rawValue);
+}
+
+bool SnapshotService::writeSnapshot(Model *model, const QString &snapshotPath)
+{
+    QFile file(snapshotPath);
+    if (!file.open(QIODevice::WriteOnly))
+    {
+        qCritical() << "[SnapshotService::writeSnapshot] ERROR: can't create " << snapshotPath;
+        return false;
+    }
+
+    // 1.: the types, their properties and the index of each MObject
+    StringPool              strings;
+    QVector<TypeRecord>     typeRecords;
+    QVector<PropertyRecord> propertyRecords;
+    QVector<Property*>      properties;
+    QVector<MObject*>       mObjects;
+    QHash<MObject*, quint32> mObjectIndexes;
+    quint64 nbValues = 0;
+    for (MObjectType *mObjectType : model->getModelObjectTypes())
+    {
+        ModelObjectView view = model->getModelObjectsView(mObjectType);
+        MObject *firstModelObject = view.first();
+        if (!firstModelObject)
+            continue;
+
+        TypeRecord typeRecord = {strings.add(mObjectType->getName()), static_cast<quint32>(propertyRecords.size()), 0,
+                                 static_cast<quint32>(mObjects.size()), 0, 0, nbValues};
+        // as the xmi: the serializable attributes but all the links so we don't need to set the reverse ones
+        for (Property *property : firstModelObject->getPropertyList())
+        {
+            SLOT_KIND kind = SLOT_KIND::LINKS;
+            if (!property->isALinkProperty())
+            {
+                if (!property->isSerializable())
+                    continue;
+                kind = property->isUnboxed() ? SLOT_KIND::RAW_ATTRIBUTE : SLOT_KIND::STRING_ATTRIBUTE;
+            }
+            PropertyRecord propertyRecord = {strings.add(property->getName()), static_cast<quint32>(kind)};
+            propertyRecords.append(propertyRecord);
+            properties.append(property);
+            ++typeRecord.nbProperties;
+        }
+        for (MObject *mObject : view)
+        {
+            mObjectIndexes.insert(mObject, static_cast<quint32>(mObjects.size()));
+            mObjects.append(mObject);
+            ++typeRecord.nbObjects;
+        }
+        nbValues += static_cast<quint64>(typeRecord.nbObjects) * typeRecord.nbProperties;
+        typeRecords.append(typeRecord);
+    }
+
+    // 2.: the records of the MObjects (ids, slots and links)
+    QVector<quint64> ids;
+    QVector<quint64> values;
+    QVector<quint32> links;
+    ids.reserve(mObjects.size());
+    values.reserve(static_cast<int>(nbValues));
+    XmiValueCatcher xmiValueCatcher;
+    for (const TypeRecord &typeRecord : typeRecords)
+    {
+        for (quint32 objIdx = typeRecord.firstObject ; objIdx < typeRecord.firstObject + typeRecord.nbObjects ; ++objIdx)
+        {
+            MObject *mObject = mObjects.at(static_cast<int>(objIdx));
+            ElemId id = mObject->getId();
+            ids.append(id.isPacked() ? id.toUInt64() : sInternedIdFlag | strings.add(id.toString()));
+
+            for (quint32 propIdx = typeRecord.firstProperty ; propIdx < typeRecord.firstProperty + typeRecord.nbProperties ; ++propIdx)
+            {
+                Property *property = properties.at(static_cast<int>(propIdx));
+                quint64 slot = 0;
+                switch (static_cast<SLOT_KIND>(propertyRecords.at(static_cast<int>(propIdx)).kind))
+                {
+                case SLOT_KIND::RAW_ATTRIBUTE:
+                {
+                    PropertyRawValue rawValue = _getRawValue(mObject, property);
+                    std::memcpy(&slot, &rawValue, sizeof(slot));
+                    break;
+                }
+                case SLOT_KIND::STRING_ATTRIBUTE:
+                    slot = xmiValueCatcher.catchValue(property, mObject) ? strings.add(xmiValueCatcher.value()) : sNoString;
+                    break;
+                case SLOT_KIND::LINKS:
+                {
+                    LinkProperty *linkProperty = static_cast<LinkProperty*>(property);
+                    MObjectList linkedObjs = linkProperty->getLinkedModelObjects(mObject, true);
+                    if (linkProperty->isMapProperty()) // QMultiMap::insert puts the duplicates in front (cf Property::getMapValuesInInsertionOrder)
+                        std::reverse(linkedObjs.begin(), linkedObjs.end());
+
+                    quint64 firstLink = static_cast<quint64>(links.size());
+                    for (MObject *linkedObj : linkedObjs)
+                    {
+                        auto itLinked = mObjectIndexes.constFind(linkedObj);
+                        if (itLinked != mObjectIndexes.cend()) // not in the model
+                            links.append(itLinked.value());
+                    }
+                    slot = (firstLink << 32) | (static_cast<quint64>(links.size()) - firstLink);
+                    break;
+                }
+                }
+                values.append(slot);
+            }
+        }
+    }
+
+    // 3.: the sections
+    Header header;
+    std::memset(&header, 0, sizeof(header));
+    std::memcpy(header.magic, sMagic, sizeof(header.magic));
+    header.version        = sVersion;
+    header.byteOrder      = sByteOrder;
+    header.nbTypes        = static_cast<quint32>(typeRecords.size());
+    header.nbProperties   = static_cast<quint32>(propertyRecords.size());
+    header.nbObjects      = static_cast<quint32>(ids.size());
+    header.nbLinks        = static_cast<quint32>(links.size());
+    header.nbStrings      = static_cast<quint32>(strings.records().size());
+    header.poolSize       = static_cast<quint32>(strings.pool().size());
+    header.nbValues       = static_cast<quint64>(values.size());
+    header.typeOffset     = align8(sizeof(Header));
+    header.propertyOffset = align8(header.typeOffset     + header.nbTypes      * sizeof(TypeRecord));
+    header.objectOffset   = align8(header.propertyOffset + header.nbProperties * sizeof(PropertyRecord));
+    header.valueOffset    = align8(header.objectOffset   + header.nbObjects    * sizeof(quint64));
+    header.linkOffset     = align8(header.valueOffset    + header.nbValues     * sizeof(quint64));
+    header.stringOffset   = align8(header.linkOffset     + header.nbLinks      * sizeof(quint32));
+    header.poolOffset     = align8(header.stringOffset   + header.nbStrings    * sizeof(StringRecord));
+    header.fileSize       = align8(header.poolOffset     + header.poolSize     * sizeof(QChar));
+
+    const char padding[8] = {0, 0, 0, 0, 0, 0, 0, 0};
+    auto writeSection = [&file, &padding](const void *data, quint64 size){
+        const qint64 paddingSize = static_cast<qint64>(align8(size) - size);
+        return file.write(static_cast<const char*>(data), static_cast<qint64>(size)) == static_cast<qint64>(size)
+                && file.write(padding, paddingSize) == paddingSize;
+    };
+    bool isWritten = writeSection(&header,                  sizeof(Header))
+            && writeSection(typeRecords.constData(),     header.nbTypes      * sizeof(TypeRecord))
+            && writeSection(propertyRecords.constData(), header.nbProperties * sizeof(PropertyRecord))
+            && writeSection(ids.constData(),             header.nbObjects    * sizeof(quint64))
+            && writeSection(values.constData(),          header.nbValues     * sizeof(quint64))
+            && writeSection(links.constData(),           header.nbLinks      * sizeof(quint32))
+            && writeSection(strings.records().constData(), header.nbStrings  * sizeof(StringRecord))
+            && writeSection(strings.pool().constData(),  header.poolSize     * sizeof(QChar))
+            && file.flush();
+    if (!isWritten)
+    {
+        qCritical() << "[SnapshotService::writeSnapshot] ERROR: can't write " << snapshotPath << ": " << file.errorString();
+        file.remove(); // no truncated snapshot
+        return false;
+    }
+    file.close();
+    return true;
+}
+
+//! the sections of a snapshot mapped in memory and the MObjectTypes and Properties they refer to
+class SnapshotService::MappedSnapshot
+{
+public:
+    explicit MappedSnapshot(const QString &snapshotPath);
+    ~MappedSnapshot();
+
+    MappedSnapshot(const MappedSnapshot &other) = delete;
+    MappedSnapshot & operator=(const MappedSnapshot &other) = delete;
+
+    bool open(Model *model); //!< map the file and check it
+
+    quint32 nbTypes()   const { return _header->nbTypes; }
+    quint32 nbObjects() const { return _header->nbObjects; }
+    const TypeRecord &typeRecord(quint32 typeIdx) const { return _typeRecords[typeIdx]; }
+    MObjectType *modelObjectType(quint32 typeIdx) const { return _mObjectTypes.at(static_cast<int>(typeIdx)); }
+
+    QString getString(quint32 index) const;
+    ElemId  getId(quint32 objIdx) const;
+    quint32 getTypeIndex(quint32 objIdx) const;
+    quint32 findModelObject(quint32 typeIdx, const ElemId &id); //!< sNoRecord if it's not in the type
+
+    //! with its attributes (the links are set by setLinks)
+    MObject *createModelObject(quint32 typeIdx, quint32 objIdx);
+
+    //! resolve(linkedObjIdx) gives the linked MObject (or nullptr to skip it)
+    template<typename Resolver> void setLinks(MObject *mObject, quint32 typeIdx, quint32 objIdx, Resolver resolve);
+
+private:
+    bool _checkSections(quint64 fileSize) const; //!< the sections fit in the file
+    bool _checkRecords() const; //!< all the indexes of the records are in the range of their section
+    void _resolveProperties(quint32 typeIdx, MObject *mObject);
+
+    QFile                 _file;
+    uchar                *_data;
+    const Header         *_header;
+    const TypeRecord     *_typeRecords;
+    const PropertyRecord *_propertyRecords;
+    const quint64        *_ids;
+    const quint64        *_values;
+    const quint32        *_links;
+    const StringRecord   *_stringRecords;
+    const QChar          *_pool;
+
+    QVector<MObjectType*>     _mObjectTypes;     //!< by type index
+    QVector<Property*>        _properties;       //!< by property index (nullptr if it doesn't match the one of the type)
+    QVector<bool>             _resolvedTypes;    //!< the Properties of the type are resolved (on its first MObject)
+    QMultiHash<QString, quint32> _internedIds;   //!< built on the first search of an interned id
+};
+
+SnapshotService::MappedSnapshot::MappedSnapshot(const QString &snapshotPath):
+    _file(snapshotPath), _data(nullptr), _header(nullptr), _typeRecords(nullptr), _propertyRecords(nullptr),
+    _ids(nullptr), _values(nullptr), _links(nullptr), _stringRecords(nullptr), _pool(nullptr),
+    _mObjectTypes(), _properties(), _resolvedTypes(), _internedIds()
+{}
+
+SnapshotService::MappedSnapshot::~MappedSnapshot()
+{
+    if (_data)
+        _file.unmap(_data);
+}
+
+bool SnapshotService::MappedSnapshot::open(Model *model)
+{
+    if (!_file.open(QIODevice::ReadOnly))
+    {
+        qCritical() << "[SnapshotService::MappedSnapshot::open] ERROR: can't open " << _file.fileName();
+        return false;
+    }
+
+    const quint64 fileSize = static_cast<quint64>(_file.size());
+    _data   = fileSize >= sizeof(Header) ? _file.map(0, static_cast<qint64>(fileSize)) : nullptr;
+    _header = reinterpret_cast<const Header*>(_data);
+    if (!_header || std::memcmp(_header->magic, sMagic, sizeof(sMagic)) != 0
+            || _header->version != sVersion || _header->byteOrder != sByteOrder || _header->fileSize != fileSize
+            || !_checkSections(fileSize))
+    {
+        qCritical() << "[SnapshotService::MappedSnapshot::open] ERROR: " << _file.fileName() << " is not a snapshot (or from another version)";
+        return false;
+    }
+
+    _typeRecords     = reinterpret_cast<const TypeRecord*>(_data + _header->typeOffset);
+    _propertyRecords = reinterpret_cast<const PropertyRecord*>(_data + _header->propertyOffset);
+    _ids             = reinterpret_cast<const quint64*>(_data + _header->objectOffset);
+    _values          = reinterpret_cast<const quint64*>(_data + _header->valueOffset);
+    _links           = reinterpret_cast<const quint32*>(_data + _header->linkOffset);
+    _stringRecords   = reinterpret_cast<const StringRecord*>(_data + _header->stringOffset);
+    _pool            = reinterpret_cast<const QChar*>(_data + _header->poolOffset);
+    if (!_checkRecords())
+    {
+        qCritical() << "[SnapshotService::MappedSnapshot::open] ERROR: " << _file.fileName() << " is corrupted";
+        return false;
+    }
+
+    for (quint32 typeIdx = 0 ; typeIdx < _header->nbTypes ; ++typeIdx)
+    {
+        const TypeRecord &record = _typeRecords[typeIdx];
+        MObjectType *mObjectType = model->getModelObjectTypeByName(getString(record.name));
+        if (!mObjectType)
+        {
+            qCritical() << "[SnapshotService::MappedSnapshot::open] ERROR: unknown MObjectType: " << getString(record.name);
+            return false;
+        }
+        _mObjectTypes.append(mObjectType);
+    }
+    _properties.fill(nullptr, static_cast<int>(_header->nbProperties));
+    _resolvedTypes.fill(false, static_cast<int>(_header->nbTypes));
+    return true;
+}
+
+bool SnapshotService::MappedSnapshot::_checkSections(quint64 fileSize) const
+{
+    // each section is aligned, starts after the previous one and its records end before the next one
+    // (the sizes are compared by division so a huge count can't overflow)
+    auto fits = [](quint64 offset, quint64 nbRecords, quint64 recordSize, quint64 begin, quint64 end){
+        return offset % 8 == 0 && offset >= begin && offset <= end && nbRecords <= (end - offset) / recordSize;
+    };
+    const Header &h = *_header;
+    return fits(h.typeOffset,     h.nbTypes,      sizeof(TypeRecord),     sizeof(Header),   h.propertyOffset)
+        && fits(h.propertyOffset, h.nbProperties, sizeof(PropertyRecord), h.typeOffset,     h.objectOffset)
+        && fits(h.objectOffset,   h.nbObjects,    sizeof(quint64),        h.propertyOffset, h.valueOffset)
+        && fits(h.valueOffset,    h.nbValues,     sizeof(quint64),        h.objectOffset,   h.linkOffset)
+        && fits(h.linkOffset,     h.nbLinks,      sizeof(quint32),        h.valueOffset,    h.stringOffset)
+        && fits(h.stringOffset,   h.nbStrings,    sizeof(StringRecord),   h.linkOffset,     h.poolOffset)
+        && fits(h.poolOffset,     h.poolSize,     sizeof(QChar),          h.stringOffset,   fileSize);
+}
+
+bool SnapshotService::MappedSnapshot::_checkRecords() const
+{
+    const Header &h = *_header;
+    for (quint32 strIdx = 0 ; strIdx < h.nbStrings ; ++strIdx)
+    {
+        const StringRecord &record = _stringRecords[strIdx];
+        if (record.offset > h.poolSize || record.size > h.poolSize - record.offset)
+            return false;
+    }
+
+    for (quint32 propIdx = 0 ; propIdx < h.nbProperties ; ++propIdx)
+    {
+        const PropertyRecord &record = _propertyRecords[propIdx];
+        if (record.name >= h.nbStrings || record.kind > static_cast<quint32>(SLOT_KIND::LINKS))
+            return false;
+    }
+
+    for (quint32 objIdx = 0 ; objIdx < h.nbObjects ; ++objIdx)
+    {
+        if ((_ids[objIdx] & sInternedIdFlag) && (_ids[objIdx] & ~sInternedIdFlag) >= h.nbStrings)
+            return false;
+    }
+
+    for (quint32 linkIdx = 0 ; linkIdx < h.nbLinks ; ++linkIdx)
+    {
+        if (_links[linkIdx] >= h.nbObjects)
+            return false;
+    }
+
+    // the MObjects of the types follow each other (cf getTypeIndex) and each one has a slot per property of its type
+    quint32 nextObject = 0;
+    for (quint32 typeIdx = 0 ; typeIdx < h.nbTypes ; ++typeIdx)
+    {
+        const TypeRecord &record = _typeRecords[typeIdx];
+        if (record.name >= h.nbStrings
+                || record.firstProperty > h.nbProperties || record.nbProperties > h.nbProperties - record.firstProperty
+                || record.firstObject != nextObject || record.nbObjects > h.nbObjects - record.firstObject
+                || record.firstValue > h.nbValues
+                || static_cast<quint64>(record.nbObjects) * record.nbProperties > h.nbValues - record.firstValue)
+            return false;
+        nextObject += record.nbObjects;
+
+        const quint64 *slot = _values + record.firstValue;
+        for (quint32 objIdx = 0 ; objIdx < record.nbObjects ; ++objIdx)
+        {
+            for (quint32 propIdx = record.firstProperty ; propIdx < record.firstProperty + record.nbProperties ; ++propIdx, ++slot)
+            {
+                switch (static_cast<SLOT_KIND>(_propertyRecords[propIdx].kind))
+                {
+                case SLOT_KIND::RAW_ATTRIBUTE:
+                    break;
+                case SLOT_KIND::STRING_ATTRIBUTE:
+                    if (*slot != sNoString && *slot >= h.nbStrings)
+                        return false;
+                    break;
+                case SLOT_KIND::LINKS:
+                    if ((*slot >> 32) + (*slot & 0xFFFFFFFF) > h.nbLinks)
+                        return false;
+                    break;
+                }
+            }
+        }
+    }
+    return nextObject == h.nbObjects;
+}
+
+QString SnapshotService::MappedSnapshot::getString(quint32 index) const
+{
+    const StringRecord &record = _stringRecords[index];
+    return QString(_pool + record.offset, static_cast<int>(record.size));
+}
+
+ElemId SnapshotService::MappedSnapshot::getId(quint32 objIdx) const
+{
+    quint64 id = _ids[objIdx];
+    return (id & sInternedIdFlag) ? ElemId::fromString(getString(static_cast<quint32>(id))) : ElemId::fromUInt64(id);
+}
+
+quint32 SnapshotService::MappedSnapshot::getTypeIndex(quint32 objIdx) const
+{
+    const TypeRecord *typeEnd = _typeRecords + _header->nbTypes;
+    const TypeRecord *it = std::upper_bound(_typeRecords, typeEnd, objIdx, [](quint32 idx, const TypeRecord &record){
+        return idx < record.firstObject;
+    });
+    return static_cast<quint32>(it - _typeRecords) - 1;
+}
+
+quint32 SnapshotService::MappedSnapshot::findModelObject(quint32 typeIdx, const ElemId &id)
+{
+    const TypeRecord &record = _typeRecords[typeIdx];
+    if (id.isPacked())
+    {
+        const quint64 *idBegin = _ids + record.firstObject, *idEnd = idBegin + record.nbObjects;
+        const quint64 *it = std::lower_bound(idBegin, idEnd, id.toUInt64());
+        return (it != idEnd && *it == id.toUInt64()) ? static_cast<quint32>(it - _ids) : sNoRecord;
+    }
+
+    if (_internedIds.isEmpty()) // their order in the snapshot is the one of the process that wrote it
+    {
+        for (quint32 objIdx = 0 ; objIdx < _header->nbObjects ; ++objIdx)
+        {
+            if (_ids[objIdx] & sInternedIdFlag)
+                _internedIds.insert(getString(static_cast<quint32>(_ids[objIdx])), objIdx);
+        }
+    }
+    const QString strId = id.toString();
+    for (auto it = _internedIds.constFind(strId), itEnd = _internedIds.constEnd(); it != itEnd && it.key() == strId; ++it)
+    {
+        if (it.value() >= record.firstObject && it.value() < record.firstObject + record.nbObjects)
+            return it.value();
+    }
+    return sNoRecord;
+}
+
+void SnapshotService::MappedSnapshot::_resolveProperties(quint32 typeIdx, MObject *mObject)
+{
+    const TypeRecord &record = _typeRecords[typeIdx];
+    for (quint32 propIdx = record.firstProperty ; propIdx < record.firstProperty + record.nbProperties ; ++propIdx)
+    {
+        Property *property = mObject->getPropertyFromName(getString(_propertyRecords[propIdx].name));
+        SLOT_KIND kind     = static_cast<SLOT_KIND>(_propertyRecords[propIdx].kind);
+        if (property && (kind == SLOT_KIND::LINKS) == property->isALinkProperty()
+                && (kind == SLOT_KIND::RAW_ATTRIBUTE) == property->isUnboxed())
+            _properties[static_cast<int>(propIdx)] = property;
+        else
+            qCritical() << "[SnapshotService::MappedSnapshot] ERROR: the property '" << getString(_propertyRecords[propIdx].name)
+                        << "' doesn't match the one of " << mObject->getModelObjectTypeName() << " (it is skipped)";
+    }
+    _resolvedTypes[static_cast<int>(typeIdx)] = true;
+}
+
+MObject *SnapshotService::MappedSnapshot::createModelObject(quint32 typeIdx, quint32 objIdx)
+{
+    const TypeRecord &record  = _typeRecords[typeIdx];
+    MObject          *mObject = modelObjectType(typeIdx)->createModelObject(0, false); // we don't want the default initialization
+    mObject->setId(getId(objIdx));
+    if (!_resolvedTypes.at(static_cast<int>(typeIdx))) // the properties are the same for all the MObjects of the type
+        _resolveProperties(typeIdx, mObject);
+
+    const quint64 *slot = _values + record.firstValue + static_cast<quint64>(objIdx - record.firstObject) * record.nbProperties;
+    for (quint32 propIdx = record.firstProperty ; propIdx < record.firstProperty + record.nbProperties ; ++propIdx, ++slot)
+    {
+        Property *property = _properties.at(static_cast<int>(propIdx));
+        if (!property)
+            continue;
+        if (static_cast<SLOT_KIND>(_propertyRecords[propIdx].kind) == SLOT_KIND::RAW_ATTRIBUTE)
+        {
+            PropertyRawValue rawValue;
+            std::memcpy(static_cast<void*>(&rawValue), slot, sizeof(rawValue));
+            _setRawValue(mObject, property, rawValue);
+        }
+        else if (static_cast<SLOT_KIND>(_propertyRecords[propIdx].kind) == SLOT_KIND::STRING_ATTRIBUTE)
+            property->deserializeFromXmiAttribute(mObject, *slot == sNoString ? QString() : getString(static_cast<quint32>(*slot)));
+    }
+    return mObject;
+}
+
+// both sides of the links are in the snapshot so the reverse links are not updated
+template<typename Resolver>
+void SnapshotService::MappedSnapshot::setLinks(MObject *mObject, quint32 typeIdx, quint32 objIdx, Resolver resolve)
+{
+    const TypeRecord &record = _typeRecords[typeIdx];
+    const quint64    *slot   = _values + record.firstValue + static_cast<quint64>(objIdx - record.firstObject) * record.nbProperties;
+    MObjectList linkedObjs;
+    for (quint32 propIdx = record.firstProperty ; propIdx < record.firstProperty + record.nbProperties ; ++propIdx, ++slot)
+    {
+        Property *property = _properties.at(static_cast<int>(propIdx));
+        if (!property || !property->isALinkProperty() || (*slot & 0xFFFFFFFF) == 0)
+            continue;
+
+        linkedObjs.clear();
+        for (quint32 linkIdx = static_cast<quint32>(*slot >> 32), linkEnd = linkIdx + static_cast<quint32>(*slot) ;
+             linkIdx < linkEnd ; ++linkIdx) // in range (cf _checkRecords)
+        {
+            MObject *linkedObj = resolve(_links[linkIdx]);
+            if (linkedObj)
+                linkedObjs.append(linkedObj);
+        }
+        if (!linkedObjs.isEmpty())
+            static_cast<LinkProperty*>(property)->initValues(mObject, linkedObjs);
+    }
+}
+
+
+//! the MObjects of a mapped snapshot are created when the Model needs them (cf LazyModelSource)
+class SnapshotService::LazySnapshot : public LazyModelSource
+{
+public:
+    explicit LazySnapshot(const QString &snapshotPath);
+    ~LazySnapshot() override;
+
+    bool open(Model *model);
+
+    MObject *materializeModelObject(MObjectType *mObjectType, const ElemId &id) override;
+    void materializeModelObjects(MObjectType *mObjectType) override;
+    void materializeAll() override;
+
+protected:
+    void loadLinks(MObject *mObject, uint record) override;
+    void detach(MObject *mObject, uint record) override;
+
+private:
+    MObject *_materialize(quint32 objIdx); //!< create the MObject if it isn't yet
+
+    MappedSnapshot           _snapshot;
+    QHash<quint32, MObject*> _mObjects;          //!< the MObjects created by record (nullptr once deleted)
+    QVector<bool>            _materializedTypes; //!< all the MObjects of the type are created
+    bool                     _materializedAll;
+};
+
+SnapshotService::LazySnapshot::LazySnapshot(const QString &snapshotPath):
+    LazyModelSource(), _snapshot(snapshotPath), _mObjects(), _materializedTypes(), _materializedAll(false)
+{}
+
+SnapshotService::LazySnapshot::~LazySnapshot()
+{
+    for (MObject *mObject : _mObjects)
+    {
+        if (mObject)
+            _detach(mObject);
+    }
+}
+
+bool SnapshotService::LazySnapshot::open(Model *model)
+{
+    if (!_snapshot.open(model))
+        return false;
+
+    // the new MObjects must not take the ids of the ones still in the snapshot
+    for (quint32 typeIdx = 0 ; typeIdx < _snapshot.nbTypes() ; ++typeIdx)
+    {
+        const TypeRecord &record = _snapshot.typeRecord(typeIdx);
+        for (quint32 objIdx = record.firstObject + record.nbObjects ; objIdx > record.firstObject ; --objIdx)
+        {
+            ElemId id = _snapshot.getId(objIdx - 1);
+            if (id.isPacked()) // the last packed one is the greatest
+            {
+                _snapshot.modelObjectType(typeIdx)->updateMaxId(id);
+                break;
+            }
+        }
+    }
+    _materializedTypes.fill(false, static_cast<int>(_snapshot.nbTypes()));
+    return true;
+}
+
+MObject *SnapshotService::LazySnapshot::materializeModelObject(MObjectType *mObjectType, const ElemId &id)
+{
+    for (quint32 typeIdx = 0 ; typeIdx < _snapshot.nbTypes() ; ++typeIdx)
+    {
+        if (!_snapshot.modelObjectType(typeIdx)->isA(mObjectType))
+            continue;
+
+        quint32 objIdx = _snapshot.findModelObject(typeIdx, id);
+        if (objIdx != sNoRecord && !_mObjects.contains(objIdx)) // already created: it was removed from the Model
+            return _materialize(objIdx);
+    }
+    return nullptr;
+}
+
+void SnapshotService::LazySnapshot::materializeModelObjects(MObjectType *mObjectType)
+{
+    for (quint32 typeIdx = 0 ; typeIdx < _snapshot.nbTypes() ; ++typeIdx)
+    {
+        if (_materializedTypes.at(static_cast<int>(typeIdx)) || _snapshot.modelObjectType(typeIdx) != mObjectType)
+            continue;
+
+        const TypeRecord &record = _snapshot.typeRecord(typeIdx);
+        for (quint32 objIdx = record.firstObject ; objIdx < record.firstObject + record.nbObjects ; ++objIdx)
+        {
+            if (!_mObjects.contains(objIdx))
+                _materialize(objIdx);
+        }
+        _materializedTypes[static_cast<int>(typeIdx)] = true;
+    }
+}
+
+void SnapshotService::LazySnapshot::materializeAll()
+{
+    if (_materializedAll)
+        return;
+
+    for (quint32 typeIdx = 0 ; typeIdx < _snapshot.nbTypes() ; ++typeIdx)
+        materializeModelObjects(_snapshot.modelObjectType(typeIdx));
+    for (quint32 objIdx = 0 ; objIdx < _snapshot.nbObjects() ; ++objIdx)
+    {
+        MObject *mObject = _mObjects.value(objIdx, nullptr);
+        if (mObject)
+            _loadLinks(mObject);
+    }
+    _materializedAll = true;
+}
+
+void SnapshotService::LazySnapshot::loadLinks(MObject *mObject, uint record)
+{
+    _snapshot.setLinks(mObject, _snapshot.getTypeIndex(record), record, [this](quint32 linkedObjIdx){
+        return _materialize(linkedObjIdx);
+    });
+}
+
+void SnapshotService::LazySnapshot::detach(MObject *mObject, uint record)
+{
+    Q_UNUSED(mObject);
+    _mObjects.insert(record, nullptr); // so it is not created again
+}
+
+MObject *SnapshotService::LazySnapshot::_materialize(quint32 objIdx)
+{
+    auto it = _mObjects.constFind(objIdx);
+    if (it != _mObjects.cend())
+        return it.value();
+
+    MObjectArena::Scope arenaScope(_model->getArena()); // no arena: the MObject is on the heap
+    MObject *mObject = _snapshot.createModelObject(_snapshot.getTypeIndex(objIdx), objIdx);
+    _attach(mObject, this, objIdx);
+    _mObjects.insert(objIdx, mObject);
+    _model->add(mObject);
+    return mObject;
+}
+
+
+bool SnapshotService::loadSnapshot(Model *model, const QString &snapshotPath)
+{
+    MappedSnapshot snapshot(snapshotPath);
+    if (!snapshot.open(model))
+        return false;
+
+    // 1.: the MObjects must not be already in the Model
+    for (quint32 typeIdx = 0 ; typeIdx < snapshot.nbTypes() ; ++typeIdx)
+    {
+        const TypeRecord &typeRecord = snapshot.typeRecord(typeIdx);
+        for (quint32 objIdx = typeRecord.firstObject ; objIdx < typeRecord.firstObject + typeRecord.nbObjects ; ++objIdx)
+        {
+            if (model->getModelObjectById(snapshot.modelObjectType(typeIdx), snapshot.getId(objIdx)))
+            {
+                qCritical() << "[SnapshotService::loadSnapshot] ERROR: the MObject " << snapshot.getId(objIdx) << " is already in the Model";
+                return false;
+            }
+        }
+    }
+
+    MObjectArena::Scope arenaScope(model->getArena()); // no arena: the MObjects are on the heap
+
+    // 2.: the MObjects and their attributes
+    QVector<MObject*> mObjects;
+    mObjects.reserve(static_cast<int>(snapshot.nbObjects()));
+    for (quint32 typeIdx = 0 ; typeIdx < snapshot.nbTypes() ; ++typeIdx)
+    {
+        const TypeRecord &typeRecord = snapshot.typeRecord(typeIdx);
+        for (quint32 objIdx = typeRecord.firstObject ; objIdx < typeRecord.firstObject + typeRecord.nbObjects ; ++objIdx)
+            mObjects.append(snapshot.createModelObject(typeIdx, objIdx));
+    }
+
+    for (int objIdx = 0 ; objIdx < mObjects.size() ; ++objIdx)
+        model->add(mObjects.at(objIdx));
+
+    // 3.: fix-up of the links
+    for (quint32 typeIdx = 0 ; typeIdx < snapshot.nbTypes() ; ++typeIdx)
+    {
+        const TypeRecord &typeRecord = snapshot.typeRecord(typeIdx);
+        for (quint32 objIdx = typeRecord.firstObject ; objIdx < typeRecord.firstObject + typeRecord.nbObjects ; ++objIdx)
+        {
+            snapshot.setLinks(mObjects.at(static_cast<int>(objIdx)), typeIdx, objIdx, [&mObjects](quint32 linkedObjIdx){
+                return mObjects.at(static_cast<int>(linkedObjIdx));
+            });
+        }
+    }
+    return true;
+}
+
+bool SnapshotService::openSnapshot(Model *model, const QString &snapshotPath)
+{
+    if (model->getLazySource())
+    {
+        qCritical() << "[SnapshotService::openSnapshot] ERROR: the Model already has a LazyModelSource";
+        return false;
+    }
+
+    LazySnapshot *lazySnapshot = new LazySnapshot(snapshotPath);
+    if (!lazySnapshot->open(model))
+    {
+        delete lazySnapshot;
+        return false;
+    }
+    model->setLazySource(lazySnapshot);
+    return true;
+}
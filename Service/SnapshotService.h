@@ -0,0 +1,72 @@
+//========================================================================
+//
+// Copyright (C) 2018 Matthieu Bruel <Matthieu.Bruel@gmail.com>
+//
+// This file is a part of miniEMF++ : https://github.com/mbruel/miniEMF
+//
+// miniEMF++ is free software; you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as
+// published by the Free Software Foundation; version 3.0 of the License.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+// You should have received a copy of the GNU Lesser General Public
+// License along with this program; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301,
+// USA.
+//
+//========================================================================
+
+#ifndef SNAPSHOTSERVICE_H
+#define SNAPSHOTSERVICE_H
+
+#include "Utils/Singleton.h"
+#include "Model/PropertyRawValue.h"
+#include <QString>
+
+class Model;
+class MObject;
+class Property;
+
+/**
+ * @brief SnapshotService writes and loads a binary image of a Model (faster than XMIService)
+ *
+ * The snapshot has a table of the types, the table of their properties, the packed records of the MObjects
+ * (id and one 8 bytes slot per property), the adjacency arrays of the links and a pool of strings
+ * (cf the format in SnapshotService.cpp). It is in the native byte order: it is not an exchange format.
+ * The loading maps the file in memory, creates the MObjects from their records
+ * then sets their links in a fix-up pass (indexes into pointers, both sides are in the snapshot).
+ * openSnapshot keeps the file mapped and only creates the MObjects the Model needs (cf LazyModelSource).
+ */
+class SnapshotService : public Singleton<SnapshotService>
+{
+    friend class Singleton<SnapshotService>;
+
+public:
+    bool writeSnapshot(Model *model, const QString &snapshotPath);
+
+    //! the MObjects of the snapshot should not be already in the model
+    bool loadSnapshot(Model *model, const QString &snapshotPath);
+
+    //! the MObjects are created on demand: getModelObjectById, a link traversal or a type iteration
+    //! the snapshot stays mapped until the Model is cleared, the Model should not have its MObjects (it is not checked)
+    bool openSnapshot(Model *model, const QString &snapshotPath);
+
+private:
+    class MappedSnapshot; // the sections of a snapshot file (shared by loadSnapshot and openSnapshot)
+    class LazySnapshot;   // the LazyModelSource of openSnapshot
+
+    SnapshotService() = default;
+    ~SnapshotService() = default;
+
+    // the unboxed values (SnapshotService is a friend of MObject)
+    static PropertyRawValue _getRawValue(const MObject *mObject, const Property *property);
+    static void _setRawValue(MObject *mObject, const Property *property, const PropertyRawValue &rawValue);
+
+    static const char    sMagic[8];
+    static const quint32 sVersion = 1;
+};
+
+#endif // SNAPSHOTSERVICE_H
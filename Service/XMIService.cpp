@@ -22,12 +22,15 @@
 #include "XMIService.h"
 #include "Model/Model.h"
 #include "Utils/XmiWriter.h"
+#include "Utils/Parallel.h"
 
 #include <QFile>
 #include <QDebug>
 #include <QDateTime>
 #include <QDomDocument>
 
+#include <algorithm>
+
 #include <Model/Property.h>
 
 
@@ -40,7 +43,7 @@ XMIService::~XMIService()
         delete _docXMI;
 }
 
-MObject *XMIService::deserializeModelObject(QDomNode node, MObjectType *mObjectType, QSet<MObjectLinkings *> *objectLinks)
+MObject *XMIService::deserializeModelObject(QDomNode node, MObjectType *mObjectType, QVector<MObjectLinkings> *objectLinks)
 {
     QString nodeName (node.toElement().tagName());
     QString strId    (node.toElement().attribute("id", "").trimmed());
@@ -87,7 +90,7 @@ MObject *XMIService::deserializeModelObject(QDomNode node, MObjectType *mObjectT
                             <<" (type: " << linkProperty->getModelObjectType()->getName()
                            << ", linkedModelObjectType: " << linkProperty->getLinkedModelObjectType()->getName() << ") value : " << strAttr;
 #endif
-                    objectLinks->insert(new MObjectLinkings(mObject, linkProperty, strAttr));
+                    objectLinks->append(MObjectLinkings(mObject, linkProperty, strAttr));
                 }
             }
         }
@@ -140,6 +143,69 @@ MObject *XMIService::deserializeModelObject(QDomNode node, MObjectType *mObjectT
     return mObject;
 }
 
+void XMIService::_linkModelObjects(Model *model, const QVector<MObjectLinkings> &objectLinks, bool inParallel)
+{
+    // 1.: resolution of the ids (it only reads the Model so it can be shared between tasks)
+    QVector<MObjectList> linkedModelObjects(objectLinks.size());
+    MObjectList *resolvedLinks = linkedModelObjects.data(); // no detach in the tasks
+    auto resolveLinks = [model, &objectLinks, resolvedLinks](int taskIdx){
+        for (int i = taskIdx * sLoadBatchSize, iEnd = qMin(i + sLoadBatchSize, objectLinks.size()) ; i < iEnd ; ++i)
+        {
+            const MObjectLinkings &objLink = objectLinks.at(i);
+            objLink.linkProp->resolveXMIStringIdList(objLink.mObj, objLink.linkValue, model, resolvedLinks[i]);
+        }
+    };
+    const int nbTasks = (objectLinks.size() + sLoadBatchSize - 1) / sLoadBatchSize;
+    if (inParallel)
+        Parallel::forEach(nbTasks, resolveLinks);
+    else
+    {
+        for (int taskIdx = 0 ; taskIdx < nbTasks ; ++taskIdx)
+            resolveLinks(taskIdx);
+    }
+
+    // 2.: the links in the order of the xmi, their reverse links are only gathered
+    struct ReverseLink {
+        MObject      *linkedObj;
+        LinkProperty *reverseProp;
+        MObject      *mObj;
+    };
+    QVector<ReverseLink> reverseLinks;
+    for (int i = 0 ; i < objectLinks.size() ; ++i)
+    {
+        const MObjectLinkings &objLink = objectLinks.at(i);
+        MObjectList &linkedObjs = resolvedLinks[i];
+        if (linkedObjs.isEmpty())
+            continue;
+
+        LinkProperty *reverseProp = objLink.linkProp->getReverseLinkProperty();
+        if (!objLink.linkProp->initValues(objLink.mObj, linkedObjs))
+            objLink.linkProp->setValueFromXMIResolvedList(objLink.mObj, linkedObjs); // already linked: diff with the current links
+        else if (reverseProp)
+        {
+            for (MObject *linkedObj : linkedObjs)
+                reverseLinks.append({linkedObj, reverseProp, objLink.mObj});
+        }
+    }
+
+    // 3.: the reverse links in bulk for each linked MObject (in the order of the xmi)
+    std::stable_sort(reverseLinks.begin(), reverseLinks.end(), [](const ReverseLink &l, const ReverseLink &r){
+        if (l.linkedObj != r.linkedObj)
+            return std::less<MObject*>()(l.linkedObj, r.linkedObj);
+        return std::less<LinkProperty*>()(l.reverseProp, r.reverseProp);
+    });
+    MObjectList mObjectsToAdd;
+    for (int i = 0, nbReverseLinks = reverseLinks.size() ; i < nbReverseLinks ; )
+    {
+        const ReverseLink &reverseLink = reverseLinks.at(i);
+        mObjectsToAdd.clear();
+        for ( ; i < nbReverseLinks && reverseLinks.at(i).linkedObj == reverseLink.linkedObj
+                                   && reverseLinks.at(i).reverseProp == reverseLink.reverseProp ; ++i)
+            mObjectsToAdd.append(reverseLinks.at(i).mObj);
+        reverseLink.reverseProp->addLinks(reverseLink.linkedObj, mObjectsToAdd);
+    }
+}
+
 #include <QRegularExpression>
 void XMIService::initFromNode(MObject *mObject, const QDomNode &node)
 {
@@ -147,7 +213,7 @@ void XMIService::initFromNode(MObject *mObject, const QDomNode &node)
     QString strName        (node.toElement().attribute("name", ""));
 //    QString strDescription (node.toElement().attribute("description", ""));
 
-    mObject->setId(strId);
+    mObject->setId(ElemId::fromString(strId));
     mObject->setName(strName);
 //    mObject->setDescription(strDescription);
 }
@@ -182,8 +248,9 @@ void XMIService::loadXMI(Model *model, bool createDefaultObjects)
     Q_UNUSED(createDefaultObjects);
 
     _model = model;
+    MObjectArena::Scope arenaScope(model->getArena()); // no arena: the MObjects are on the heap
 
-    QSet<MObjectLinkings*> objectLinks;
+    QVector<MObjectLinkings> objectLinks;
     for(QDomNode node = _docXMI->documentElement().firstChild(); !node.isNull(); node = node.nextSibling())
     {
         QString nodeType(node.nodeName()); //osam.functional:Function
@@ -204,13 +271,7 @@ void XMIService::loadXMI(Model *model, bool createDefaultObjects)
 
 
     // Deserialize links between mObjects
-    for (MObjectLinkings *objLink : objectLinks)
-    {
-        LinkProperty *linkProperty = objLink->linkProp;
-        linkProperty->setValueFromXMIStringIdList(objLink->mObj, objLink->linkValue, model);
-    }
-
-    qDeleteAll(objectLinks);
+    _linkModelObjects(model, objectLinks);
 
     delete _docXMI;
     _docXMI = nullptr;
@@ -255,92 +316,313 @@ bool XMIService::exportXMI(MObject *elemToExport, Model *model, const QString &x
 
 #include <QXmlStreamReader>
 
-
-MObject *XMIService::deserializeModelObject(
-        Model *model,
-        QXmlStreamReader &xmlReader,
-        MObjectType *mObjectType,
-        const QString &endTag,
-        QSet<MObjectLinkings *> &elementLinkings)
+struct XMIService::LoadBatch
+{
+    struct Attribute {
+        MObject  *mObject;
+        Property *property;
+        QString   xmiValue;
+    };
+    struct Containment {
+        MObject      *mObject;
+        LinkProperty *linkProperty;
+        MObject      *childElement;
+    };
+
+    QVector<MObject*>        mObjects;     //!< the new MObjects, to add in the Model
+    QVector<Attribute>       attributes;   //!< of the MObjects already in the Model
+    QVector<Containment>     containments; //!< involving a MObject already in the Model (and the next ones of its parent)
+    QVector<MObjectLinkings> objectLinks;
+    QString                  error;
+};
+
+bool XMIService::loadXMIStream(Model *model, const QString &xmiPath, bool inParallel)
 {
-    MObject *mObject = mObjectType->createModelObject(0, false); // we don't want the default initialization
-    mObject->setId(xmlReader.attributes().value("id").toString());
+    QFile xmiFile(xmiPath);
+    if (!xmiFile.open(QIODevice::ReadOnly))
+    {
+        qCritical() << "[XMIService::loadXMIStream] ERROR: can't open " << xmiPath;
+        return false;
+    }
 
-    model->add(mObjectType, mObject);
+    // the id lookups of the tasks would create the MObjects of the source and add them in the Model
+    if (model->getLazySource())
+        inParallel = false;
 
-    qDebug() << "[XMIService::deserializeModelObject] >>>>> new " << mObjectType->getName()
-             << ": " << mObject->getName() << " (id: " << mObject->getId() << ")"
-             << " endTag: " << endTag;
+    MObjectArena::Scope arenaScope(model->getArena()); // no arena: the MObjects are on the heap
 
-    // First do all the non containment properties that are on the current line
-    QMap<QString, Property *> nonContainmentProps = mObject->getNonContainmentProperties();
-    for (auto it = nonContainmentProps.cbegin(), itEnd = nonContainmentProps.cend(); it != itEnd ; ++it)
+    QVector<MObjectLinkings> objectLinks;
+    bool success = true;
+    if (inParallel)
     {
-        const QString & propName = it.key();
-        Property *const property = it.value();
-        QString strAttr = xmlReader.attributes().value(propName).toString();
-        if (property->isAttributeProperty())
-            property->deserializeFromXmiAttribute(mObject, strAttr);
+        QByteArray xmi = xmiFile.readAll(); // the tasks need a random access on the file
+        QVector<QPair<int, int>> rootElements;
+        int prologSize = 0;
+        if (_findRootElements(xmi, rootElements, prologSize))
+            success = _loadXMIInParallel(model, xmi, prologSize, rootElements, objectLinks);
         else
-            elementLinkings.insert(new MObjectLinkings(mObject, static_cast<LinkProperty*>(property), strAttr));
+        {
+            inParallel = false;
+            xmiFile.seek(0); // the sequential reader will report the error
+        }
+    }
+
+    if (!inParallel)
+    {
+        QXmlStreamReader xmlReader(&xmiFile);
+        xmlReader.setNamespaceProcessing(false); // as the QDomDocument of initImportXMI (prefixed tags)
+
+        if (xmlReader.readNextStartElement()) // the Model
+            _loadRootElements(model, xmlReader, objectLinks);
+
+        success = !xmlReader.hasError();
+        if (!success)
+            qCritical() << "[XMIService::loadXMIStream] ERROR: in " << xmiPath
+                        << " at line " << xmlReader.lineNumber() << ", column " << xmlReader.columnNumber()
+                        << " : " << xmlReader.errorString();
     }
 
-    // Now all the containment properties (childs) until we reach the endTag
-    QMap<QString, LinkProperty *>  containmentProps = mObject->getContainmentProperties();
-    do
+    if (success)
+        _linkModelObjects(model, objectLinks, inParallel);
+
+    return success;
+}
+
+void XMIService::_loadRootElements(Model *model, QXmlStreamReader &xmlReader,
+                                   QVector<MObjectLinkings> &objectLinks, LoadBatch *batch)
+{
+    while (xmlReader.readNextStartElement())
     {
-        QXmlStreamReader::TokenType tokenType = xmlReader.readNext();
-        if (xmlReader.name() == endTag && tokenType == QXmlStreamReader::EndElement)
+        QString nodeType(xmlReader.qualifiedName().toString()); //osam.functional:Function
+        QStringList nodeTypePath = nodeType.split(':');
+        if (nodeTypePath.size() == 2)
+            nodeType = nodeTypePath.at(1);
+        MObjectType *mObjectType = model->getModelObjectTypeByName(nodeType);
+        if (!mObjectType)
         {
-            qDebug() << "[XMIService::deserializeModelObject] <<<< end " << mObjectType->getName()
-                     << ": " << mObject->getName() << " (id: " << mObject->getId() << ")"
-                     << " endTag: " << endTag;
-            break;
+            qDebug() << "[XMIService::loadXMIStream] ERROR xmi: unknown MObjectType: " << nodeType;
+            xmlReader.skipCurrentElement();
+            continue;
         }
 
-        QString       propertyName = xmlReader.name().toString();
-        if (propertyName.isEmpty())
-            continue; // avoid TokenType::Characters
+        deserializeModelObject(model, xmlReader, mObjectType, objectLinks, batch);
+    }
+}
 
-        LinkProperty *linkProperty = containmentProps.value(propertyName);
-        if (!linkProperty)
+bool XMIService::_loadXMIInParallel(Model *model, const QByteArray &xmi, int prologSize, const QVector<QPair<int, int> > &rootElements,
+                                    QVector<MObjectLinkings> &objectLinks)
+{
+    // Each task parses sLoadBatchSize root elements with its own QXmlStreamReader.
+    // The Model and its MObjects are only read by the tasks (ids of the MObjects already there):
+    // they only modify the MObjects they create, the changes of the others are done by the calling thread
+    // with the addition of the new MObjects, once they're all done.
+    // The tasks don't see each other MObjects: an id should only be defined once in the xmi.
+    // The tasks don't use the arena of the Model (it isn't thread safe): their MObjects are on the heap.
+    const int nbBatches = (rootElements.size() + sLoadBatchSize - 1) / sLoadBatchSize;
+    QVector<LoadBatch> batches(nbBatches);
+    LoadBatch *batchData = batches.data(); // no detach in the tasks
+    Parallel::forEach(nbBatches, [this, model, &xmi, prologSize, &rootElements, batchData](int batchIdx){
+        LoadBatch &batch = batchData[batchIdx];
+        int firstRoot = batchIdx * sLoadBatchSize, lastRoot = qMin(firstRoot + sLoadBatchSize, rootElements.size()) - 1;
+        int start = rootElements.at(firstRoot).first, end = rootElements.at(lastRoot).second;
+
+        // the root elements of the batch under a fake document element
+        // after the prolog of the file so that they are decoded with its encoding
+        QByteArray batchXmi;
+        batchXmi.reserve(prologSize + end - start + 16);
+        batchXmi.append(xmi.constData(), prologSize);
+        batchXmi.append("<batch>").append(xmi.constData() + start, end - start).append("</batch>");
+
+        QXmlStreamReader xmlReader(batchXmi);
+        xmlReader.setNamespaceProcessing(false);
+        if (xmlReader.readNextStartElement())
+            _loadRootElements(model, xmlReader, batch.objectLinks, &batch);
+
+        if (xmlReader.hasError())
+            batch.error = QString("root elements %1 to %2: %3").arg(firstRoot + 1).arg(lastRoot + 1).arg(xmlReader.errorString());
+    });
+
+    // merge in the order of the file (so we get the same Model than the sequential load)
+    bool success = true;
+    for (LoadBatch &batch : batches)
+    {
+        for (MObject *mObject : batch.mObjects)
+            model->add(mObject);
+        for (const LoadBatch::Attribute &attribute : batch.attributes)
+            attribute.property->deserializeFromXmiAttribute(attribute.mObject, attribute.xmiValue);
+        for (const LoadBatch::Containment &containment : batch.containments)
+            _addContainmentLink(containment.mObject, containment.linkProperty, containment.childElement);
+        objectLinks += batch.objectLinks;
+        if (!batch.error.isEmpty())
+        {
+            qCritical() << "[XMIService::loadXMIStream] ERROR: " << batch.error;
+            success = false;
+        }
+    }
+    return success;
+}
+
+bool XMIService::_findRootElements(const QByteArray &xmi, QVector<QPair<int, int> > &rootElements, int &prologSize)
+{
+    const char *data = xmi.constData();
+    const int   size = xmi.size();
+    int depth = 0, rootStart = -1;
+    for (int pos = 0 ; pos < size ; ++pos)
+    {
+        if (data[pos] != '<')
+            continue;
+        if (pos + 1 == size)
+            return false;
+
+        char next = data[pos + 1];
+        if (next == '?' || next == '!') // processing instruction, comment, CDATA or DOCTYPE
+        {
+            const char *endMarker = ">";
+            if (next == '?')
+                endMarker = "?>";
+            else if (qstrncmp(data + pos, "<!--", 4) == 0)
+                endMarker = "-->";
+            else if (qstrncmp(data + pos, "<![CDATA[", 9) == 0)
+                endMarker = "]]>";
+            pos = xmi.indexOf(endMarker, pos + 2);
+            if (pos == -1)
+                return false;
+            pos += static_cast<int>(qstrlen(endMarker)) - 1;
+            continue;
+        }
+
+        // end of the tag (a '>' can be in the attribute values)
+        int  tagEnd = pos + 1;
+        char quote  = 0;
+        for ( ; tagEnd < size ; ++tagEnd)
+        {
+            char c = data[tagEnd];
+            if (quote)
+            {
+                if (c == quote)
+                    quote = 0;
+            }
+            else if (c == '"' || c == '\'')
+                quote = c;
+            else if (c == '>')
+                break;
+        }
+        if (tagEnd == size)
+            return false;
+
+        if (next == '/') // EndElement
+        {
+            if (--depth < 0)
+                return false;
+            if (depth == 1)
+                rootElements.append(qMakePair(rootStart, tagEnd + 1));
+        }
+        else if (data[tagEnd - 1] == '/') // empty element
+        {
+            if (depth == 1)
+                rootElements.append(qMakePair(pos, tagEnd + 1));
+        }
+        else if (depth == 0)
         {
-            qDebug() << "[XMIService::loadProject] Error on " << mObjectType->getName()
-                     << ": couldn't find child named: " << propertyName
-                     << " (object id: " << mObject->getId() << ")"
-                     << " endTag: " << endTag
-                     << ", tokenType: " << tokenType
-                     << ", error: " << xmlReader.errorString();
+            prologSize = pos;
+            ++depth;
         }
+        else if (depth++ == 1)
+            rootStart = pos;
+
+        pos = tagEnd;
+    }
+    return depth == 0;
+}
+
+MObject *XMIService::deserializeModelObject(Model *model, QXmlStreamReader &xmlReader, MObjectType *mObjectType,
+                                            QVector<MObjectLinkings> &objectLinks, LoadBatch *batch)
+{
+    // same steps than the QDomNode version (so we get the same Model)
+    QXmlStreamAttributes attributes = xmlReader.attributes();
+    QString strId(attributes.value("id").toString().trimmed());
+
+    MObject *mObject = model->getModelObjectById(mObjectType, strId);
+    if (!mObject)
+    {
+        mObject = mObjectType->createModelObject(0, false); // we don't want the default initialization
+        mObject->setId(ElemId::fromString(strId));
+        mObject->setName(attributes.value("name").toString());
+        if (batch)
+            batch->mObjects.append(mObject);
         else
+            model->add(mObjectType, mObject);
+    }
+    const bool isShared = batch && mObject->isInModel(); // other tasks may read it
+
+    for (Property *const property : mObject->getPropertyList())
+    {
+        if (property->isALinkProperty())
         {
-            MObjectType *childType = linkProperty->getLinkedModelObjectType();
-            if (childType->isDerived())
+            LinkProperty *linkProperty = static_cast<LinkProperty*>(property);
+            if (linkProperty->isEcoreContainment() || linkProperty->isEcoreContainer())
+                continue; // the containment are the child elements, the container is set by the parent
+
+            // stored for a post treatment (when all mObjects have been identified)
+            QString strAttr = attributes.value(property->getName()).toString();
+            if (!strAttr.isEmpty())
+                objectLinks.append(MObjectLinkings(mObject, linkProperty, strAttr));
+        }
+        else if (isShared)
+            batch->attributes.append({mObject, property, attributes.value(property->getName()).toString()});
+        else
+            property->deserializeFromXmiAttribute(mObject, attributes.value(property->getName()).toString());
+    }
+
+    // the child elements (containment) until our EndElement
+    const QMap<QString, LinkProperty *> &containmentProps = mObject->getContainmentProperties();
+    bool deferLinks = isShared; // once a link is deferred, the next ones too so they stay in the order of the xmi
+    while (xmlReader.readNextStartElement())
+    {
+        QString childTagName(xmlReader.qualifiedName().toString());
+        LinkProperty *linkProperty = containmentProps.value(childTagName, nullptr);
+        if (!linkProperty)
+        {
+            qDebug() << "[XMIService::deserializeModelObject] ERROR xmi: the property '"
+                     << childTagName << "' doesn't exist for the object: " << mObjectType->getName();
+            xmlReader.skipCurrentElement();
+            continue;
+        }
+
+        MObjectType *childModelObjectType = linkProperty->getLinkedModelObjectType();
+        if (childModelObjectType->isDerived())
+        {
+            QString xsiTypeValue = xmlReader.attributes().value("MObjectType").toString();
+            if (!xsiTypeValue.isEmpty())
             {
-                QString xsiTypeValue = xmlReader.attributes().value("MObjectType").toString();
-                if (!xsiTypeValue.isEmpty())
+                QStringList xsiTypeValueSplitted = xsiTypeValue.split(":");
+                if (xsiTypeValueSplitted.size() == 2)
                 {
-                    QStringList xsiTypeValueSplitted = xsiTypeValue.split(":");
-                    if (xsiTypeValueSplitted.size() == 2)
-                    {
-                        QString realChildType = xsiTypeValueSplitted.at(1).trimmed();
-                        childType = model->getModelObjectTypeByName(realChildType);
-                        qDebug() << "[XMIService::deserializeModelObject] " << mObjectType->getName()
-                                 << ": " << mObject->getName() << " (id: " << mObject->getId() << ")"
-                                 << " has a derived child: " << realChildType;
-
-                    }
+                    QString realEltTypeName = xsiTypeValueSplitted.at(1).trimmed();
+                    childModelObjectType = model->getModelObjectTypeByName(realEltTypeName);
                 }
             }
-            MObject *childElement = deserializeModelObject(model, xmlReader, childType, propertyName, elementLinkings);
-            linkProperty->addLink(mObject, childElement);
-            LinkToOneProperty *containerProp = static_cast<LinkToOneProperty*>(linkProperty->getReverseLinkProperty());
-            if (containerProp)
-                containerProp->setValue(childElement, mObject);
         }
-    } while (!xmlReader.atEnd());
+
+        MObject *childElement = deserializeModelObject(model, xmlReader, childModelObjectType, objectLinks, batch);
+        if (batch && (deferLinks || childElement->isInModel()))
+        {
+            deferLinks = true;
+            batch->containments.append({mObject, linkProperty, childElement});
+        }
+        else
+            _addContainmentLink(mObject, linkProperty, childElement);
+    }
 
     return mObject;
 }
 
+void XMIService::_addContainmentLink(MObject *mObject, LinkProperty *linkProperty, MObject *childElement)
+{
+    linkProperty->addLink(mObject, childElement);
+    LinkToOneProperty *containerProp = static_cast<LinkToOneProperty*>(linkProperty->getReverseLinkProperty());
+    if (containerProp)
+        containerProp->setValue(childElement, mObject);
+}
+
 
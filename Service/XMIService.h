@@ -25,6 +25,8 @@
 #include "Utils/Singleton.h"
 #include <QString>
 #include <QVariant>
+#include <QVector>
+#include <QPair>
 #include "Model/MObject.h"
 #include "Utils/XmiWriter.h"
 
@@ -34,7 +36,7 @@ class QXmlStreamWriter;
 class QFile;
 
 class Model;
-class MObjectLinkings;
+struct MObjectLinkings;
 class QXmlStreamReader;
 
 class XMIService : public Singleton<XMIService>
@@ -45,27 +47,45 @@ public:
 
     bool initImportXMI(const QString &xmiPath);
     void loadXMI(Model *model, bool createDefaultObjects = true);
+
+    //! single pass on the file with a QXmlStreamReader (no QDomDocument in memory)
+    //! gives the same Model than initImportXMI + loadXMI
+    //! inParallel (opt-in): the root elements are parsed by batches on the QThreadPool (cf _loadXMIInParallel)
+    bool loadXMIStream(Model *model, const QString &xmiPath, bool inParallel = false);
+
     bool writeXMI(Model *model, const QString &xmiPath, const QString &applicationName,
                   XmiWriter::XMI_TYPE xmiType = XmiWriter::XMI_TYPE::FULL_DUMP);
 
     bool exportXMI(MObject *elemToExport, Model *model, const QString &xmiPath, const QString &applicationName);
 
 
-
-    MObject *deserializeModelObject(Model *model,
-                                    QXmlStreamReader &xmlReader,
-                                    MObjectType *mObjectType,
-                                    const QString &endTag,
-                                    QSet<MObjectLinkings *> &elementLinkings);
-
 private:
     XMIService();
     ~XMIService();
 
+    struct LoadBatch; // what a task of _loadXMIInParallel parsed (applied to the Model by the calling thread)
+
     QDomDocument *_docXMI;
     Model        *_model;
 
-    MObject *deserializeModelObject(QDomNode node, MObjectType *mObjectType, QSet<MObjectLinkings *> *objectLinks);
+    MObject *deserializeModelObject(QDomNode node, MObjectType *mObjectType, QVector<MObjectLinkings> *objectLinks);
+    //! the xmlReader is on the StartElement of the MObject, it is left on its EndElement
+    //! batch (parallel load): only the new MObjects are modified, they and the changes of the others are stored in it
+    MObject *deserializeModelObject(Model *model, QXmlStreamReader &xmlReader, MObjectType *mObjectType,
+                                    QVector<MObjectLinkings> &objectLinks, LoadBatch *batch = nullptr);
+    //! deserialize all the child elements of the current one (the root elements of the Model)
+    void _loadRootElements(Model *model, QXmlStreamReader &xmlReader,
+                           QVector<MObjectLinkings> &objectLinks, LoadBatch *batch = nullptr);
+    bool _loadXMIInParallel(Model *model, const QByteArray &xmi, int prologSize, const QVector<QPair<int, int>> &rootElements,
+                            QVector<MObjectLinkings> &objectLinks);
+    void _linkModelObjects(Model *model, const QVector<MObjectLinkings> &objectLinks, bool inParallel = false);
+    static void _addContainmentLink(MObject *mObject, LinkProperty *linkProperty, MObject *childElement);
+
+    //! [start, end) of the children of the document element, false if the xmi is not well formed
+    //! prologSize: what is before the document element (xml declaration with the encoding, comments...)
+    static bool _findRootElements(const QByteArray &xmi, QVector<QPair<int, int>> &rootElements, int &prologSize);
+
+    static const int sLoadBatchSize = 64; //!< number of root elements parsed by a task of _loadXMIInParallel
 
     void initFromNode(MObject *mObject, const QDomNode &node);
 
@@ -21,19 +21,19 @@ Meeting::~Meeting()
 }
 
 QDateTime   Meeting::getDate()         { return PROPERTY_date->getValue(this); }
-MObjectMap *Meeting::getParticipants() { return PROPERTY_participants->getValues(this); }
+const MObjectMap &Meeting::getParticipants() { return PROPERTY_participants->constValues(this); }
 
 void Meeting::setDate(QDateTime value)            { PROPERTY_date->setValue(this, value); }
 void Meeting::setParticipants(MObjectList &values){ PROPERTY_participants->updateValue(this, values); }
 
 QString Meeting::getInfo()
 {
-    QString info("Meeting "+ getName() + " (id=" + getId() + ")");
+    QString info("Meeting "+ getName() + " (id=" + getId().toString() + ")");
     info += " at " + getDate().toString("ddd MMMM d hh:mm:ss.zzz");
     info += " with: ";
     ushort i = 0;
-    MObjectMap *participants = getParticipants();
-    for (auto it = participants->cbegin(); it != participants->cend(); ++it)
+    const MObjectMap &participants = getParticipants();
+    for (auto it = participants.cbegin(); it != participants.cend(); ++it)
     {
         if (++i !=0 )
             info += " and ";
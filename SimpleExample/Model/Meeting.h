@@ -23,7 +23,7 @@ public:
 
     // Getters
     QDateTime getDate();
-    MObjectMap *getParticipants();
+    const MObjectMap &getParticipants(); //!< read only
 
 
     // Setters
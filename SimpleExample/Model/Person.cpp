@@ -28,9 +28,9 @@ int              Person::getAge()     { return PROPERTY_age->getValue(this); }
 int              Person::getSex()     { return PROPERTY_sex->getValue(this); }
 QString          Person::getSexName() { return PROPERTY_sex->getEnumValueByKey(getSex()); }
 Person          *Person::getPartner() { return static_cast<Person*>(PROPERTY_partner->getValue(this)); }
-QSet<MObject *> *Person::getParents() { return PROPERTY_parents->getValues(this); }
-MObjectMap      *Person::getChilds()  { return PROPERTY_childs->getValues(this); }
-MObjectMultiMap *Person::getMeetings(){ return PROPERTY_meetings->getValues(this); }
+const MObjectSmallSet &Person::getParents() { return PROPERTY_parents->constValues(this); }
+const MObjectMap      &Person::getChilds()  { return PROPERTY_childs->constValues(this); }
+const MObjectMultiMap &Person::getMeetings(){ return PROPERTY_meetings->constValues(this); }
 
 void Person::setAge(int value) { PROPERTY_age->setValue(this, value); }
 void Person::setSex(const QString &value)
@@ -57,14 +57,14 @@ QString Person::getInfo()
     else
         info += ", he's single";
 
-    QSet<MObject *> *parents = getParents();
-    if (parents->isEmpty())
+    const MObjectSmallSet &parents = getParents();
+    if (parents.isEmpty())
         info += ", he has no parents...";
     else
     {
-        info += ", he has " + QString::number(parents->size()) + " parents : ";
+        info += ", he has " + QString::number(parents.size()) + " parents : ";
         ushort i = 0;
-        for (MObject *parent : *parents)
+        for (MObject *parent : parents)
         {
             if (i++ != 0)
                 info += " and ";
@@ -73,27 +73,27 @@ QString Person::getInfo()
     }
 
 
-    MObjectMap *children = getChilds();
-    if (children->isEmpty())
+    const MObjectMap &children = getChilds();
+    if (children.isEmpty())
         info += ", he has no children...";
     else
     {
-        info += ", he has " + QString::number(children->size()) + " children : ";
+        info += ", he has " + QString::number(children.size()) + " children : ";
         ushort i = 0;
-        for (const QVariant &childAge : children->keys())
+        for (auto it = children.cbegin() ; it != children.cend() ; ++it)
         {
             if (i++ != 0)
                 info += " and ";
-            info += children->value(childAge)->getName();
+            info += it.value()->getName();
         }
     }
 
-    MObjectMultiMap *meetings = getMeetings();
-    if (!meetings->isEmpty()){
-        info += ", he's involved in "+QString::number(meetings->size())+" meetings: ";
+    const MObjectMultiMap &meetings = getMeetings();
+    if (!meetings.isEmpty()){
+        info += ", he's involved in "+QString::number(meetings.size())+" meetings: ";
         ushort i = 0;
 
-        for (auto it = meetings->cbegin() ; it != meetings->cend() ; ++it)
+        for (auto it = meetings.cbegin() ; it != meetings.cend() ; ++it)
         {
             if (i++ != 0)
                 info += " and ";
@@ -101,7 +101,7 @@ QString Person::getInfo()
         }
     }
 
-    info += " (id: " + getId() + ")";
+    info += " (id: " + getId().toString() + ")";
 
     return info;
 }
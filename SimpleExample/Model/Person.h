@@ -29,9 +29,9 @@ public:
     int getSex();
     QString getSexName();
     Person *getPartner();
-    QSet<MObject *> *getParents();
-    MObjectMap *getChilds();
-    MObjectMultiMap *getMeetings();
+    const MObjectSmallSet &getParents(); //!< read only (use the setters or the Properties to change the links)
+    const MObjectMap &getChilds();
+    const MObjectMultiMap &getMeetings();
 
 
     // Setters
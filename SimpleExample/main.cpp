@@ -2,6 +2,7 @@
 #include <QTranslator>
 
 #include "Model/Model.h"
+#include "Model/PropertyAggregator.h"
 #include "Model/Constant.h"
 #include "Model/SimpleExampleTypeFactory.h"
 #include "Model/SimpleExamplePropertyFactory.h"
@@ -10,6 +11,7 @@
 #include <QtGlobal> // Q_ASSERT
 
 #include <Service/XMIService.h>
+#include <Service/SnapshotService.h>
 
 
 void initStatics(){
@@ -21,6 +23,10 @@ void initStatics(){
 void initMetaModel(){
     SimpleExampleTypeFactory::getInstance()->initModelObjectTypes();
     SimpleExamplePropertyFactory::getInstance()->initProperties();
+
+    // the hierarchy is frozen: isA is a bit test
+    Q_ASSERT(Person::TYPE->isFrozen() && Person::TYPE->isA(MObject::TYPE) && !Person::TYPE->isA(Meeting::TYPE));
+    Q_ASSERT(MObject::TYPE->getInstanciableModelObjectTypesArray().size() == 2);
 }
 
 
@@ -91,17 +97,17 @@ int main(int argc, char *argv[])
     Q_ASSERT(alice->getPartner() == mat);
 
     mat->setParents({mum, dad});
-    Q_ASSERT(mat->getParents()->size() == 2);
-    Q_ASSERT(mum->getChilds()->size() == 1);
-    Q_ASSERT(*mum->getChilds()->begin() == mat);
-    Q_ASSERT(dad->getChilds()->size() == 1);
-    Q_ASSERT(*dad->getChilds()->begin() == mat);
+    Q_ASSERT(mat->getParents().size() == 2);
+    Q_ASSERT(mum->getChilds().size() == 1);
+    Q_ASSERT(*mum->getChilds().begin() == mat);
+    Q_ASSERT(dad->getChilds().size() == 1);
+    Q_ASSERT(*dad->getChilds().begin() == mat);
 
     Person *bebe = createPerson(&model, "Bebe", 11*7, Constant::C_Female);
     Q_ASSERT(model.getModelObjects(Person::TYPE).size() == 5);
     bebe->setParents({mum, mat});
-    Q_ASSERT(mum->getChilds()->size() == 2);
-    Q_ASSERT(mat->getChilds()->size() == 1);
+    Q_ASSERT(mum->getChilds().size() == 2);
+    Q_ASSERT(mat->getChilds().size() == 1);
 
 
     Person *philippe = createPerson(&model, "Philippe", 62, Constant::C_Male);
@@ -115,14 +121,14 @@ int main(int argc, char *argv[])
 
     alice->setParents({momo, philippe});
     lucie->setParents({momo, philippe});
-    Q_ASSERT(momo->getChilds()->size() == 2);
-    Q_ASSERT(philippe->getChilds()->size() == 2);
+    Q_ASSERT(momo->getChilds().size() == 2);
+    Q_ASSERT(philippe->getChilds().size() == 2);
 
 
     Person *juliou = createPerson(&model, "Juliette", 7, Constant::C_Female);
     Q_ASSERT(model.getModelObjects(Person::TYPE).size() == 9);
     juliou->setParents({lucie});
-    Q_ASSERT(lucie->getChilds()->size() == 1);
+    Q_ASSERT(lucie->getChilds().size() == 1);
 
 
     Person *unknown = createPerson(&model, "unknown", 32, Constant::C_Female);
@@ -135,22 +141,90 @@ int main(int argc, char *argv[])
     MObjectList participants = {mat, alice, lucie, juliou};
     meeting1->setParticipants(participants);
 //    qDebug() << meeting1->getInfo();
-    Q_ASSERT(meeting1->getParticipants()->size() == 4);
+    Q_ASSERT(meeting1->getParticipants().size() == 4);
     for (MObject *p : participants)
-        Q_ASSERT(static_cast<Person*>(p)->getMeetings()->size() == 1);
+        Q_ASSERT(static_cast<Person*>(p)->getMeetings().size() == 1);
 
     Meeting *meeting2 = createMeeting(&model, "Meeting Mum");
     participants = {mat, mum, bebe};
     meeting2->setParticipants(participants);
 //    qDebug() << meeting2->getInfo();
-    Q_ASSERT(meeting2->getParticipants()->size() == 3);
-    Q_ASSERT(mat->getMeetings()->size() == 2);
+    Q_ASSERT(meeting2->getParticipants().size() == 3);
+    Q_ASSERT(mat->getMeetings().size() == 2);
 
     printAllPersons({mat, alice, dad, mum, bebe, lucie, philippe, momo, juliou});
 
     model.dumpModelObjectTypeMap();
 
 
+    // I.7.: keep the ages of the Persons in a column and scan it
+    model.enableColumnarStorage(Person::TYPE);
+    Q_ASSERT(model.getColumn(Person::TYPE, Person::PROPERTY_age)->size() == 10);
+    Q_ASSERT(juliou->getAge() == 7);
+    int sumOfAges = 0;
+    model.forEachValue(Person::TYPE, Person::PROPERTY_age, [&sumOfAges](int age){ sumOfAges += age; });
+    Q_ASSERT(sumOfAges == 35 + 67 + 65 + 34 + 77 + 62 + 61 + 32 + 7 + 32);
+
+    // I.8.: aggregations (on the column of the Persons)
+    Q_ASSERT(PropertyAggregator::sum(&model, Person::TYPE, Person::PROPERTY_age) == sumOfAges);
+    Q_ASSERT(PropertyAggregator::max(&model, Person::TYPE, Person::PROPERTY_age) == 77);
+    Q_ASSERT(PropertyAggregator::min(&model, Person::TYPE, Person::PROPERTY_age) == 7);
+    Q_ASSERT(PropertyAggregator::countWhere(&model, Person::TYPE, Person::PROPERTY_age, [](int age){ return age >= 60; }) == 5);
+    Q_ASSERT(PropertyAggregator::histogram(&model, Person::TYPE, Person::PROPERTY_age, 0., 100., 10).at(4) == 4); // [30, 40[
+
+    // I.9.: index the names (kept up to date when renaming)
+    model.enableNameIndex(MObject::TYPE);
+    Q_ASSERT(model.getModelObjectByName(Person::TYPE, "Juliette") == juliou);
+    Q_ASSERT(model.getModelObjectByName(MObject::TYPE, "Meeting Mum") == meeting2);
+    juliou->setName("Juju");
+    Q_ASSERT(model.getModelObjectByName(Person::TYPE, "Juju") == juliou);
+    Q_ASSERT(!model.getModelObjectByName(Person::TYPE, "Juliette"));
+    juliou->setName("Juliette");
+
+    // I.10.: secondary index on the ages (range queries)
+    model.createOrderedIndex(Person::TYPE, Person::PROPERTY_age);
+    Q_ASSERT(model.findModelObjectsInRange(Person::TYPE, Person::PROPERTY_age, 30, 35).size() == 4);
+    Q_ASSERT(model.findModelObjects(Person::TYPE, Person::PROPERTY_age, 32) == MObjectList({lucie, unknown}));
+    juliou->setAge(32);
+    Q_ASSERT(model.findModelObjects(Person::TYPE, Person::PROPERTY_age, 32).size() == 3);
+    juliou->setAge(7);
+    Q_ASSERT(model.findModelObjects(Person::TYPE, Person::PROPERTY_age, 7) == MObjectList({juliou}));
+
+    // I.11.: views (no copy of the MObjects)
+    ModelObjectView allObjects = model.getModelObjectsView(MObject::TYPE, true);
+    Q_ASSERT(allObjects.count() == 12);
+    ModelObjectView seniors = model.getModelObjectsView(Person::TYPE).filter([](MObject *mObj){
+        return static_cast<Person*>(mObj)->getAge() >= 60;
+    });
+    Q_ASSERT(seniors.count() == 5);
+    Q_ASSERT(seniors.first() == dad);
+    MObjectSet meetingsDone = {meeting1};
+    Q_ASSERT(model.getModelObjectsView(Meeting::TYPE).exclude(&meetingsDone).first() == meeting2);
+
+    // I.12.: parallel validation (same errors, same order)
+    QStringList serialErrors, parallelErrors;
+    model.validate(serialErrors);
+    model.validate(parallelErrors, QSet<MObjectType*>(), true);
+    Q_ASSERT(serialErrors == parallelErrors);
+
+    // I.13.: incremental validation (only the changed MObjects and their neighbours are validated again)
+    QStringList incrementalErrors;
+    model.incrementalValidate(incrementalErrors);
+    Q_ASSERT(incrementalErrors == serialErrors);
+    unknown->setPartner(dad);
+    serialErrors.clear(); incrementalErrors.clear();
+    model.validate(serialErrors);
+    model.incrementalValidate(incrementalErrors);
+    Q_ASSERT(incrementalErrors == serialErrors);
+    unknown->setPartner(nullptr);
+
+    // I.14.: the age is the key of the childs: only the entry of Juliette is moved in the map of Lucie
+    juliou->setAge(8);
+    Q_ASSERT(lucie->getChilds().value(8) == juliou && !lucie->getChilds().contains(7));
+    juliou->setAge(7);
+    Q_ASSERT(lucie->getChilds().value(7) == juliou);
+
+
 
 
 
@@ -166,15 +240,53 @@ int main(int argc, char *argv[])
     qDebug() << "\n Reload model from xmi saved before";
     Model model2(SimpleExampleTypeFactory::getInstance(),
                  "miniEmfExample", "v1.0", "Simple Example MiniEMF", 43, "");
+    model2.enableArena(); // the MObjects loaded are freed in bulk by clearModel
     QTime loadingTime;
     loadingTime.start();
     if (xmiService->initImportXMI(xmiOutput))
         xmiService->loadXMI(&model2);
     qDebug("\n#### Loading xmi done in: %d ms\n", loadingTime.elapsed());
+    Q_ASSERT(model2.getArena()->nbAllocations() > 0);
     model2.dumpModelObjectTypeMap();
     xmiService->writeXMI(&model2, xmiOutput+".copy", "miniEmf");
     Q_ASSERT(model2 == model);
 
+    // II.2.b: same load in a single pass on the file (no QDomDocument)
+    Model modelStream(SimpleExampleTypeFactory::getInstance(),
+                      "miniEmfExample", "v1.0", "Simple Example MiniEMF", 44, "");
+    bool streamLoaded = xmiService->loadXMIStream(&modelStream, xmiOutput);
+    Q_ASSERT(streamLoaded && modelStream == model);
+    xmiService->writeXMI(&modelStream, xmiOutput+".stream", "miniEmf");
+
+    // II.2.c: same load with the root elements parsed in parallel
+    Model modelParallel(SimpleExampleTypeFactory::getInstance(),
+                        "miniEmfExample", "v1.0", "Simple Example MiniEMF", 45, "");
+    bool parallelLoaded = xmiService->loadXMIStream(&modelParallel, xmiOutput, true);
+    Q_ASSERT(parallelLoaded && modelParallel == model);
+    xmiService->writeXMI(&modelParallel, xmiOutput+".parallel", "miniEmf");
+
+    // II.2.d: binary snapshot (memory mapped when loaded)
+    SnapshotService *snapshotService = SnapshotService::getInstance();
+    Model modelSnapshot(SimpleExampleTypeFactory::getInstance(),
+                        "miniEmfExample", "v1.0", "Simple Example MiniEMF", 46, "");
+    bool snapshotLoaded = snapshotService->writeSnapshot(&model, xmiOutput+".snapshot")
+            && snapshotService->loadSnapshot(&modelSnapshot, xmiOutput+".snapshot");
+    Q_ASSERT(snapshotLoaded && modelSnapshot == model);
+    xmiService->writeXMI(&modelSnapshot, xmiOutput+".snapshot.xml", "miniEmf");
+
+    // II.2.e: same snapshot opened lazily (the MObjects are created when they are first used)
+    Model modelLazy(SimpleExampleTypeFactory::getInstance(),
+                    "miniEmfExample", "v1.0", "Simple Example MiniEMF", 47, "");
+    bool snapshotOpened = snapshotService->openSnapshot(&modelLazy, xmiOutput+".snapshot");
+    Person *lazyMat = static_cast<Person*>(modelLazy.getModelObjectById(Person::TYPE, mat->getId()));
+    Q_ASSERT(snapshotOpened && lazyMat && lazyMat->getName() == mat->getName());
+    Q_ASSERT(lazyMat->getPartner()->getId() == mat->getPartner()->getId()); // link traversal
+    Q_ASSERT(lazyMat->getMeetings().size() == 2);
+    modelLazy.dumpModelObjectTypeMap("only Mat and his neighbours");
+    Q_ASSERT(modelLazy.getModelObjectsView(Person::TYPE).count() == 10); // type iteration
+    Q_ASSERT(modelLazy == model);
+    xmiService->writeXMI(&modelLazy, xmiOutput+".lazy.xml", "miniEmf");
+
 
     // II.3: Test export 1 Element
     // the "unknown" Person should not be in the export
@@ -191,14 +303,14 @@ int main(int argc, char *argv[])
 
     model.remove(meeting2);
     qDebug() << "\n Meeting2 has been removed from the model (kind of deleted except we could Undo ;))";
-    Q_ASSERT(mat->getMeetings()->size() == 1);
-    Q_ASSERT(mum->getMeetings()->size() == 0);
-    Q_ASSERT(bebe->getMeetings()->size() == 0);
+    Q_ASSERT(mat->getMeetings().size() == 1);
+    Q_ASSERT(mum->getMeetings().size() == 0);
+    Q_ASSERT(bebe->getMeetings().size() == 0);
     printAllPersons({mat, mum, bebe});
 
     qDebug() << "\n Juliette has been removed from the model (kind of deleted except we could Undo ;))";
     model.remove(juliou);
-    Q_ASSERT(meeting1->getParticipants()->size() == 3);
+    Q_ASSERT(meeting1->getParticipants().size() == 3);
     qDebug() << meeting1->getInfo();
 
     model.dumpModelObjectTypeMap();
@@ -209,6 +321,19 @@ int main(int argc, char *argv[])
     model.dumpModelObjectTypeMap();
 
     model2.clearModel();
+    Q_ASSERT(model2.getArena()->nbAllocations() == 0 && model2.getArena()->nbBlocks() == 0);
+
+    // a MObject that outlives its Model keeps the blocks of the arena until it is deleted
+    Person *survivor = nullptr;
+    {
+        Model modelArena(SimpleExampleTypeFactory::getInstance(),
+                         "miniEmfExample", "v1.0", "Simple Example MiniEMF", 48, "");
+        modelArena.enableArena();
+        MObjectArena::Scope arenaScope(modelArena.getArena());
+        survivor = static_cast<Person*>(Person::TYPE->createModelObject(48));
+        Q_ASSERT(modelArena.getArena()->nbAllocations() == 1);
+    }
+    delete survivor; // and the orphaned arena with it
 
     return 0;
 //    return app.exec();
@@ -0,0 +1,113 @@
+//========================================================================
+//
+// Copyright (C) 2018 Matthieu Bruel <Matthieu.Bruel@gmail.com>
+//
+// This file is a part of miniEMF++ : https://github.com/mbruel/miniEMF
+//
+// miniEMF++ is free software; you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as
+// published by the Free Software Foundation; version 3.0 of the License.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+// You should have received a copy of the GNU Lesser General Public
+// License along with this program; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301,
+// USA.
+//
+//========================================================================
+
+#ifndef PARALLEL_H
+#define PARALLEL_H
+
+#include "PureStaticClass.h"
+#include <QThreadPool>
+#include <QRunnable>
+#include <QSemaphore>
+#include <QAtomicInt>
+
+/*!
+ * \brief Runs nbTasks independent tasks on a QThreadPool
+ *
+ * The tasks are pulled from a shared counter by the calling thread and
+ * by up to maxThreadCount() helpers of the pool.
+ * forEach returns once every task is done.
+ * If the pool is busy (nested call) the caller simply runs everything.
+ * function(int taskIdx) must not touch shared data without synchronisation.
+ */
+class Parallel : public PureStaticClass
+{
+public:
+    template<typename Function>
+    static void forEach(int nbTasks, Function function, QThreadPool *pool = QThreadPool::globalInstance());
+
+private:
+    template<typename Function>
+    class Worker : public QRunnable
+    {
+    public:
+        inline Worker(int nbTasks, Function &function, QAtomicInt &nextTask, QSemaphore *done = nullptr);
+
+        inline void run() override;
+
+    private:
+        const int   _nbTasks;
+        Function   &_function;
+        QAtomicInt &_nextTask;
+        QSemaphore *_done;
+    };
+};
+
+
+///////////////////////////////////////////////////////
+/// Template functions definition (generic)
+///
+template<typename Function>
+void Parallel::forEach(int nbTasks, Function function, QThreadPool *pool)
+{
+    if (nbTasks <= 0)
+        return;
+
+    QAtomicInt nextTask(0);
+    QSemaphore done;
+    int nbHelpers = 0;
+    if (pool)
+    {
+        int maxHelpers = qMin(nbTasks - 1, pool->maxThreadCount());
+        for (int i = 0 ; i < maxHelpers ; ++i)
+        {
+            Worker<Function> *helper = new Worker<Function>(nbTasks, function, nextTask, &done);
+            helper->setAutoDelete(true);
+            if (!pool->tryStart(helper))
+            {
+                delete helper; // pool full: the running ones will take its share
+                break;
+            }
+            ++nbHelpers;
+        }
+    }
+
+    Worker<Function> caller(nbTasks, function, nextTask);
+    caller.run();
+
+    done.acquire(nbHelpers);
+}
+
+template<typename Function>
+Parallel::Worker<Function>::Worker(int nbTasks, Function &function, QAtomicInt &nextTask, QSemaphore *done):
+    QRunnable(), _nbTasks(nbTasks), _function(function), _nextTask(nextTask), _done(done)
+{}
+
+template<typename Function>
+void Parallel::Worker<Function>::run()
+{
+    for (int taskIdx = _nextTask.fetchAndAddOrdered(1) ; taskIdx < _nbTasks ; taskIdx = _nextTask.fetchAndAddOrdered(1))
+        _function(taskIdx);
+
+    if (_done)
+        _done->release();
+}
+
+#endif // PARALLEL_H
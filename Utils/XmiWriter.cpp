@@ -84,7 +84,8 @@ void XmiWriter::writeEndDocument()
 
 void XmiWriter::write(MObjectType *mObjectType)
 {
-    QMap<QString, MObject *> *mObjects = _model->_getModelObjectMap(mObjectType);
+    _model->_materializeModelObjects(mObjectType, false);
+    QMap<ElemId, MObject *> *mObjects = _model->_getModelObjectMap(mObjectType);
     QString tagName(mObjectType->getName());
     for (auto it = mObjects->cbegin() , itEnd = mObjects->cend(); it != itEnd ; ++it)
         it.value()->serialize(this, tagName);
@@ -171,7 +172,7 @@ void XmiWriter::addAttribute(const QString &name, const QDateTime &value)
 void XmiWriter::addAttribute(const QString &name, MObject *mObject)
 {
     if (mObject && !name.isEmpty())
-        addAttribute(name, mObject->getId());
+        addAttribute(name, mObject->getId().toString());
 }
 
 
@@ -185,7 +186,7 @@ void XmiWriter::addAttribute(const QString &name, const QList<MObject *> &mObjec
         {
             if (nb++ != 0)
                 value += " ";
-            value += mObj->getId();
+            value += mObj->getId().toString();
         }
         addAttribute(name, value);
     }
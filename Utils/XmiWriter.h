@@ -57,7 +57,7 @@ public:
     void writeStartElement(const QString &tagName);
     void writeEndElement();
 
-    void addAttribute(const QString &name, const QString &value);
+    virtual void addAttribute(const QString &name, const QString &value); //!< all the other ones end up here
     void addAttribute(const QString &name, bool value);
     void addAttribute(const QString &name, int value);
     void addAttribute(const QString &name, double value);
@@ -7,13 +7,24 @@ use_hmi {
 }
 
 SOURCES += \
+    $$PWD/Model/AttributeIndex.cpp \
+    $$PWD/Model/ColumnarStore.cpp \
+    $$PWD/Model/ElemId.cpp \
+    $$PWD/Model/LazyModelSource.cpp \
+    $$PWD/Model/MapKey.cpp \
     $$PWD/Model/MObject.cpp \
+    $$PWD/Model/MObjectArena.cpp \
     $$PWD/Model/MObjectTypeFactory.cpp \
     $$PWD/Model/MObjectType.cpp \
     $$PWD/Model/Model.cpp \
+    $$PWD/Model/ModelObjectView.cpp \
+    $$PWD/Model/NameIndex.cpp \
     $$PWD/Model/PropertyFactory.cpp \
     $$PWD/Model/Property.cpp \
+    $$PWD/Model/PropertyLayout.cpp \
+    $$PWD/Model/ValidationCache.cpp \
 \
+    $$PWD/Service/SnapshotService.cpp \
     $$PWD/Service/XMIService.cpp \
 \
     $$PWD/Utils/XmiWriter.cpp
@@ -21,15 +32,32 @@ SOURCES += \
 
 HEADERS += \
     $$PWD/Model/aliases.h \
+    $$PWD/Model/AttributeIndex.h \
+    $$PWD/Model/ColumnarStore.h \
+    $$PWD/Model/ElemId.h \
+    $$PWD/Model/LazyModelSource.h \
+    $$PWD/Model/MapKey.h \
     $$PWD/Model/MObject.h \
+    $$PWD/Model/MObjectArena.h \
     $$PWD/Model/MObjectTypeFactory.h \
     $$PWD/Model/MObjectType.h \
     $$PWD/Model/Model.h \
+    $$PWD/Model/ModelObjectView.h \
+    $$PWD/Model/NameIndex.h \
+    $$PWD/Model/OrderedSet.h \
     $$PWD/Model/PropertyFactory.h \
     $$PWD/Model/Property.h \
+    $$PWD/Model/PropertyLayout.h \
+    $$PWD/Model/PropertyObserver.h \
+    $$PWD/Model/PropertyAggregator.h \
+    $$PWD/Model/PropertyRawValue.h \
+    $$PWD/Model/SmallSet.h \
+    $$PWD/Model/ValidationCache.h \
 \
+    $$PWD/Service/SnapshotService.h \
     $$PWD/Service/XMIService.h \
 \
+    $$PWD/Utils/Parallel.h \
     $$PWD/Utils/PureStaticClass.h \
     $$PWD/Utils/Singleton.h \
     $$PWD/Utils/XmiWriter.h